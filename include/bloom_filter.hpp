@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace detail
+{
+    // Blocked Bloom filter: a key sets one bit in each of the eight words of
+    // a single cache-line block, so a query costs one cache miss and eight
+    // independent bit tests. The block comes from the high half of a
+    // multiplicative mix of the hash, the bits from the low half times one
+    // odd salt per word. Bits are never cleared; the owner rebuilds the
+    // filter to drop erased keys.
+    class blocked_bloom_filter
+    {
+    public:
+        // Discards every key and sizes the filter to block_count blocks.
+        void reset(size_t block_count) { blocks_.assign(block_count, Block{}); }
+
+        size_t block_count() const { return blocks_.size(); }
+
+        void insert(uint64_t hash)
+        {
+            const uint64_t mixed = hash * 0x9E3779B97F4A7C15ull;
+            Block &block = blocks_[block_of(mixed)];
+            for (size_t i = 0; i < WORDS; ++i)
+            {
+                block.words[i] |= bit_of(mixed, i);
+            }
+        }
+
+        // False means the hash was never inserted; true may be a false
+        // positive.
+        bool may_contain(uint64_t hash) const
+        {
+            const uint64_t mixed = hash * 0x9E3779B97F4A7C15ull;
+            const Block &block = blocks_[block_of(mixed)];
+            uint64_t missing = 0;
+            for (size_t i = 0; i < WORDS; ++i)
+            {
+                missing |= ~block.words[i] & bit_of(mixed, i);
+            }
+            return missing == 0;
+        }
+
+        const void *block_address(uint64_t hash) const
+        {
+            return &blocks_[block_of(hash * 0x9E3779B97F4A7C15ull)];
+        }
+
+    private:
+        static constexpr size_t WORDS = 8;
+        static constexpr uint32_t SALTS[WORDS] = {0x47B6137Bu, 0x44974D91u, 0x8824AD5Bu, 0xA2B7289Du,
+                                                  0x705495C7u, 0x2DF1424Bu, 0x9EFC4947u, 0x5C6BFB31u};
+
+        struct alignas(64) Block
+        {
+            uint64_t words[WORDS] = {};
+        };
+
+        size_t block_of(uint64_t mixed) const
+        {
+            return static_cast<size_t>(((mixed >> 32) * blocks_.size()) >> 32);
+        }
+
+        static uint64_t bit_of(uint64_t mixed, size_t word)
+        {
+            return uint64_t(1) << ((static_cast<uint32_t>(mixed) * SALTS[word]) >> 26);
+        }
+
+        std::vector<Block> blocks_;
+    };
+}
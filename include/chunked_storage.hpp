@@ -0,0 +1,272 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace detail
+{
+    // Growable array kept as fixed-size chunks: growth allocates one more
+    // chunk and never moves the elements already stored. With CopyOnWrite the
+    // chunks are reference counted, copying the container copies only the
+    // chunk pointers, and the first write to a chunk that is still shared
+    // replaces it with a private copy. Const access never copies.
+    template <typename T, size_t ChunkSize, bool CopyOnWrite>
+    class chunked_vector
+    {
+        static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+    public:
+        chunked_vector() = default;
+        chunked_vector(chunked_vector &&other) noexcept = default;
+        chunked_vector &operator=(chunked_vector &&other) noexcept = default;
+
+        chunked_vector(const chunked_vector &other) : size_(other.size_)
+        {
+            if constexpr (CopyOnWrite)
+            {
+                chunks_ = other.chunks_;
+            }
+            else
+            {
+                chunks_.reserve(other.chunks_.size());
+                for (const auto &chunk : other.chunks_)
+                {
+                    chunks_.push_back(std::make_unique<Chunk>(*chunk));
+                }
+            }
+        }
+
+        chunked_vector &operator=(const chunked_vector &other)
+        {
+            if (this != &other)
+            {
+                chunked_vector copy(other);
+                swap(copy);
+            }
+            return *this;
+        }
+
+        void swap(chunked_vector &other) noexcept
+        {
+            chunks_.swap(other.chunks_);
+            std::swap(size_, other.size_);
+        }
+
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+        const T &operator[](size_t i) const { return chunks_[i >> SHIFT]->items()[i & MASK]; }
+        T &operator[](size_t i) { return writable(i >> SHIFT).items()[i & MASK]; }
+
+        template <typename... Args>
+        T &emplace_back(Args &&...args)
+        {
+            const size_t chunk_index = size_ >> SHIFT;
+            if (chunk_index == chunks_.size())
+            {
+                chunks_.push_back(make_chunk());
+            }
+            Chunk &chunk = writable(chunk_index);
+            T *item = ::new (static_cast<void *>(chunk.items() + chunk.count)) T(std::forward<Args>(args)...);
+            ++chunk.count;
+            ++size_;
+            return *item;
+        }
+
+        void pop_back()
+        {
+            Chunk &chunk = writable((size_ - 1) >> SHIFT);
+            --chunk.count;
+            chunk.items()[chunk.count].~T();
+            --size_;
+        }
+
+        void resize(size_t n)
+        {
+            while (size_ > n)
+            {
+                pop_back();
+            }
+            while (size_ < n)
+            {
+                emplace_back();
+            }
+        }
+
+        // Only the chunk table is reserved; chunks are allocated as they fill.
+        void reserve(size_t n) { chunks_.reserve((n + MASK) >> SHIFT); }
+
+        void clear()
+        {
+            chunks_.clear();
+            size_ = 0;
+        }
+
+        // Frees the chunks that pop_back emptied.
+        void shrink_to_fit()
+        {
+            chunks_.erase(chunks_.begin() + ((size_ + MASK) >> SHIFT), chunks_.end());
+            chunks_.shrink_to_fit();
+        }
+
+        // Gives every still-shared chunk a private copy, so that threads can
+        // then write disjoint elements without racing to copy the same chunk.
+        void detach()
+            requires CopyOnWrite
+        {
+            for (size_t c = 0; c < chunks_.size(); ++c)
+            {
+                writable(c);
+            }
+        }
+
+    private:
+        static constexpr size_t SHIFT = std::countr_zero(ChunkSize);
+        static constexpr size_t MASK = ChunkSize - 1;
+
+        struct Chunk
+        {
+            Chunk() = default;
+
+            Chunk(const Chunk &other)
+            {
+                try
+                {
+                    for (; count < other.count; ++count)
+                    {
+                        ::new (static_cast<void *>(items() + count)) T(other.items()[count]);
+                    }
+                }
+                catch (...)
+                {
+                    destroy();
+                    throw;
+                }
+            }
+
+            Chunk &operator=(const Chunk &) = delete;
+
+            ~Chunk() { destroy(); }
+
+            T *items() { return std::launder(reinterpret_cast<T *>(storage)); }
+            const T *items() const { return std::launder(reinterpret_cast<const T *>(storage)); }
+
+            void destroy()
+            {
+                for (; count > 0; --count)
+                {
+                    items()[count - 1].~T();
+                }
+            }
+
+            alignas(T) unsigned char storage[sizeof(T) * ChunkSize];
+            size_t count = 0;              // Constructed prefix of storage
+            std::atomic<size_t> owners{1}; // Copy-on-write only
+        };
+
+        // Intrusively counted chunk handle. unique() is an acquire load that
+        // pairs with the release in every other owner's drop, so a writer that
+        // finds itself the last owner also sees their reads as finished.
+        class SharedChunk
+        {
+        public:
+            explicit SharedChunk(Chunk *chunk) : chunk_(chunk) {}
+            SharedChunk(const SharedChunk &other) : chunk_(other.chunk_)
+            {
+                chunk_->owners.fetch_add(1, std::memory_order_relaxed);
+            }
+            SharedChunk(SharedChunk &&other) noexcept : chunk_(std::exchange(other.chunk_, nullptr)) {}
+            SharedChunk &operator=(SharedChunk other) noexcept
+            {
+                std::swap(chunk_, other.chunk_);
+                return *this;
+            }
+            ~SharedChunk()
+            {
+                if (chunk_ && chunk_->owners.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    delete chunk_;
+                }
+            }
+
+            Chunk &operator*() const { return *chunk_; }
+            Chunk *operator->() const { return chunk_; }
+            bool unique() const { return chunk_->owners.load(std::memory_order_acquire) == 1; }
+
+        private:
+            Chunk *chunk_;
+        };
+
+        using ChunkPtr = std::conditional_t<CopyOnWrite, SharedChunk, std::unique_ptr<Chunk>>;
+
+        static ChunkPtr make_chunk() { return ChunkPtr(new Chunk()); }
+
+        Chunk &writable(size_t c)
+        {
+            if constexpr (CopyOnWrite)
+            {
+                if (!chunks_[c].unique())
+                {
+                    chunks_[c] = SharedChunk(new Chunk(*chunks_[c]));
+                }
+            }
+            return *chunks_[c];
+        }
+
+        std::vector<ChunkPtr> chunks_;
+        size_t size_ = 0;
+    };
+}
+
+// Storage policies for unordered_dense_map: where the bucket index and the
+// dense entries live. A policy names the container template for each.
+namespace dense_storage
+{
+    // One std::vector for each; the default.
+    struct contiguous
+    {
+        template <typename T>
+        using bucket_container = std::vector<T>;
+        template <typename T>
+        using entry_container = std::vector<T>;
+
+        static constexpr bool cheap_copy = false;
+    };
+
+    // Entries in private chunks of ChunkSize elements; buckets stay in one
+    // vector, since a rehash rebuilds them anyway. Growing the map allocates
+    // one more chunk and never moves an entry, so references to entries stay
+    // valid across inserts (erase still moves the last entry into the hole)
+    // and growth needs no second copy of the entry array.
+    template <size_t ChunkSize = 4096>
+    struct chunked
+    {
+        template <typename T>
+        using bucket_container = std::vector<T>;
+        template <typename T>
+        using entry_container = detail::chunked_vector<T, ChunkSize, false>;
+
+        static constexpr bool cheap_copy = false;
+    };
+
+    // Buckets and entries in reference-counted chunks of ChunkSize elements.
+    // Copying the map shares every chunk, and a write copies only the chunk
+    // it lands in, so snapshot() costs O(number of chunks). Writes through a
+    // non-const accessor pay a reference-count check.
+    template <size_t ChunkSize = 4096>
+    struct copy_on_write
+    {
+        template <typename T>
+        using bucket_container = detail::chunked_vector<T, ChunkSize, true>;
+        template <typename T>
+        using entry_container = detail::chunked_vector<T, ChunkSize, true>;
+
+        static constexpr bool cheap_copy = true;
+    };
+}
@@ -5,9 +5,17 @@
 #include <memory>
 #include <thread>
 #include <shared_mutex>
-#include <array>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
 #include <cstring>
 
+// Concurrent map built from independently locked segments. Segments are found
+// through an extendible-hashing directory indexed by the top global_depth bits
+// of the hash: when a segment grows past SEGMENT_SPLIT_THRESHOLD entries it is
+// split in two, doubling the directory only when the segment was already at
+// global depth. Resize work therefore stays bounded by the threshold and the
+// number of independently lockable segments grows with the data.
 template <typename Key, typename Value, typename Hash = detail::hash_traits<Key>>
 class concurrent_unordered_dense_map
 {
@@ -15,7 +23,11 @@ private:
     static constexpr size_t INITIAL_CAPACITY = 16;
     static constexpr float MAX_LOAD_FACTOR = 0.75f;
     static constexpr size_t MAX_DISTANCE = 255;
-    static constexpr size_t SEGMENT_COUNT = 64;
+    static constexpr size_t INITIAL_GLOBAL_DEPTH = 6; // 64 segments
+    static constexpr size_t MAX_GLOBAL_DEPTH = 24;
+    static constexpr size_t SEGMENT_SPLIT_THRESHOLD = 8192;
+    static constexpr size_t MAX_CLUSTER_RESIZES = 4;
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
 
     struct AtomicBucket
     {
@@ -81,37 +93,91 @@ private:
     struct Segment
     {
         std::atomic<size_t> size{0};
-        std::atomic<size_t> capacity{INITIAL_CAPACITY / SEGMENT_COUNT};
-        std::unique_ptr<AtomicBucket[]> buckets;
+        std::atomic<size_t> capacity{INITIAL_CAPACITY};
+        std::atomic<AtomicBucket *> buckets{nullptr}; // Atomic only for the lock-free prefetch
         std::atomic<Entry *> entries{nullptr};
         std::atomic<size_t> entries_capacity{0};
+        size_t local_depth;
+        bool retired = false; // Set under mutex once split; holders of a stale pointer start over
+        bool unsplittable = false; // Set under mutex when a split half could not be indexed
         mutable std::shared_mutex mutex;
 
-        Segment()
+        Segment(size_t initial_capacity, size_t depth) : capacity(initial_capacity), local_depth(depth)
         {
-            buckets = std::make_unique<AtomicBucket[]>(capacity.load());
+            buckets.store(new AtomicBucket[capacity.load()]);
             entries_capacity = capacity.load();
             entries.store(new Entry[entries_capacity]);
         }
 
         ~Segment()
         {
+            delete[] buckets.load();
             delete[] entries.load();
         }
 
+        // Caller must hold mutex (either side).
+        AtomicBucket &bucket(size_t pos) const { return buckets.load(std::memory_order_relaxed)[pos]; }
+
         Segment(const Segment &) = delete;
         Segment &operator=(const Segment &) = delete;
         Segment(Segment &&) = delete;
         Segment &operator=(Segment &&) = delete;
     };
 
-    std::array<std::unique_ptr<Segment>, SEGMENT_COUNT> segments_;
+    // slots[i] serves every hash whose top global_depth bits equal i. A
+    // segment of local depth d is referenced by 2^(global_depth - d)
+    // consecutive slots. A slot only ever changes to point at one half of
+    // the segment it named.
+    struct Directory
+    {
+        size_t global_depth;
+        std::vector<std::atomic<Segment *>> slots;
+
+        explicit Directory(size_t depth) : global_depth(depth), slots(size_t(1) << depth) {}
+
+        size_t index(uint64_t hash) const
+        {
+            return global_depth == 0 ? 0 : static_cast<size_t>(hash >> (64 - global_depth));
+        }
+
+        // First slot referencing the segment at slot index.
+        size_t canonical_index(size_t index) const
+        {
+            size_t shift = global_depth - slots[index].load(std::memory_order_acquire)->local_depth;
+            return (index >> shift) << shift;
+        }
+    };
+
+    // Operations load directory_ without a lock and lock only the segment it
+    // names. Splits are serialised by split_mutex_ and publish their halves
+    // through the directory's slots, or through a new doubled directory. The
+    // old directories and segments stay allocated until destruction, because
+    // a reader may still hold a pointer to them. Each directory replaces one
+    // half its size, and a split segment keeps only its lock once its arrays
+    // are freed.
+    std::atomic<Directory *> directory_{nullptr};
+    std::vector<std::unique_ptr<Directory>> directories_;
+    std::vector<std::unique_ptr<Segment>> segments_;
+    mutable std::mutex split_mutex_;
     std::atomic<size_t> total_size_{0};
 
-    size_t get_segment_index(const Key &key) const
+    // Locks the live segment serving hash; Lock is std::shared_lock or
+    // std::unique_lock. A segment that turns out to have been split between
+    // the directory load and the lock is skipped, and the lookup retried.
+    template <typename Lock>
+    Segment &lock_segment(uint64_t hash, Lock &lock) const
     {
-        uint64_t hash = Hash::hash(key);
-        return hash % SEGMENT_COUNT;
+        while (true)
+        {
+            const Directory *directory = directory_.load(std::memory_order_acquire);
+            Segment *segment = directory->slots[directory->index(hash)].load(std::memory_order_acquire);
+            lock = Lock(segment->mutex);
+            if (!segment->retired)
+            {
+                return *segment;
+            }
+            lock.unlock();
+        }
     }
 
 public:
@@ -120,6 +186,7 @@ public:
     using value_type = std::pair<const Key, Value>;
     using size_type = size_t;
 
+    // Iteration is not synchronised with writers; iterate once writers are done.
     class const_iterator
     {
     public:
@@ -132,7 +199,8 @@ public:
 
         const value_type &operator*() const
         {
-            const auto &segment = map_->segments_[segment_idx_];
+            const Directory &directory = *map_->directory_.load(std::memory_order_acquire);
+            const Segment *segment = directory.slots[segment_idx_].load(std::memory_order_acquire);
             const Entry *entries = segment->entries.load();
             return reinterpret_cast<const value_type &>(entries[entry_idx_]);
         }
@@ -162,9 +230,10 @@ public:
         void find_next_valid()
         {
             ++entry_idx_;
-            while (segment_idx_ < SEGMENT_COUNT)
+            const Directory &directory = *map_->directory_.load(std::memory_order_acquire);
+            while (segment_idx_ < directory.slots.size())
             {
-                const auto &segment = map_->segments_[segment_idx_];
+                const Segment *segment = directory.slots[segment_idx_].load(std::memory_order_acquire);
                 size_t seg_size = segment->size.load();
 
                 if (entry_idx_ < seg_size)
@@ -178,140 +247,144 @@ public:
                 }
                 else
                 {
-                    ++segment_idx_;
+                    // Skip the other directory slots that share this segment
+                    segment_idx_ += size_t(1) << (directory.global_depth - segment->local_depth);
                     entry_idx_ = 0;
                 }
             }
+            segment_idx_ = npos;
+            entry_idx_ = 0;
         }
     };
 
     concurrent_unordered_dense_map()
     {
-        for (size_t i = 0; i < SEGMENT_COUNT; ++i)
+        auto directory = std::make_unique<Directory>(INITIAL_GLOBAL_DEPTH);
+        for (auto &slot : directory->slots)
         {
-            segments_[i] = std::make_unique<Segment>();
+            segments_.push_back(std::make_unique<Segment>(INITIAL_CAPACITY, INITIAL_GLOBAL_DEPTH));
+            slot.store(segments_.back().get(), std::memory_order_relaxed);
         }
+        directory_.store(directory.get(), std::memory_order_release);
+        directories_.push_back(std::move(directory));
     }
 
     bool contains(const Key &key) const
     {
-        return find(key) != end();
+        return contains_hashed(key, Hash::hash(key));
+    }
+
+    // The *_hashed calls below are the same operations for callers that
+    // already hold Hash::hash(key).
+    bool contains_hashed(const Key &key, uint64_t hash) const
+    {
+        std::shared_lock<std::shared_mutex> lock;
+        const Segment &segment = lock_segment(hash, lock);
+        return find_in_segment(segment, key, hash) != npos;
     }
 
     const_iterator find(const Key &key) const
     {
-        size_t seg_idx = get_segment_index(key);
-        const auto &segment = segments_[seg_idx];
+        return find_hashed(key, Hash::hash(key));
+    }
 
-        uint64_t hash = Hash::hash(key);
-        uint8_t fingerprint = Hash::fingerprint(key);
+    const_iterator find_hashed(const Key &key, uint64_t hash) const
+    {
+        std::shared_lock<std::shared_mutex> lock;
+        const Segment &segment = lock_segment(hash, lock);
 
-        size_t capacity = segment->capacity.load();
-        size_t ideal_pos = hash % capacity;
-        size_t current_pos = ideal_pos;
-        size_t distance = 0;
+        size_t entry_idx = find_in_segment(segment, key, hash);
+        if (entry_idx == npos)
+        {
+            return end();
+        }
+        // The segment cannot be split while it is locked, so every directory
+        // from the one that led here onwards still names it
+        const Directory &directory = *directory_.load(std::memory_order_acquire);
+        return const_iterator(this, directory.canonical_index(directory.index(hash)), entry_idx);
+    }
 
-        while (distance < MAX_DISTANCE)
+    bool insert(const Key &key, const Value &value)
+    {
+        return insert_hashed(key, Hash::hash(key), value);
+    }
+
+    bool insert_hashed(const Key &key, uint64_t hash, const Value &value)
+    {
+        while (true)
         {
-            auto bucket_data = segment->buckets[current_pos].unpack();
+            // Writers to the same segment are serialised; readers only need
+            // the shared side, so resize can never free entries under them.
+            std::unique_lock<std::shared_mutex> lock;
+            Segment &segment = lock_segment(hash, lock);
 
-            if (bucket_data.is_empty())
+            if (find_in_segment(segment, key, hash) != npos)
             {
-                break;
+                return false;
             }
 
-            if (bucket_data.is_tombstone())
+            if (segment.size.load() >= SEGMENT_SPLIT_THRESHOLD && segment.local_depth < MAX_GLOBAL_DEPTH &&
+                !segment.unsplittable)
             {
-                current_pos = (current_pos + 1) % capacity;
-                ++distance;
+                lock.unlock();
+                split_segment(hash);
                 continue;
             }
 
-            if (bucket_data.is_occupied() && bucket_data.fingerprint == fingerprint)
+            // A segment too clustered to rebuild keeps its arrays while they
+            // have room
+            const size_t max_capacity = segment.capacity.load() << MAX_CLUSTER_RESIZES;
+            if (segment.size.load() >= segment.capacity.load() * MAX_LOAD_FACTOR)
             {
-                const Entry *entries = segment->entries.load();
-                if (bucket_data.entry_index < segment->size.load() &&
-                    entries[bucket_data.entry_index].valid.load() &&
-                    entries[bucket_data.entry_index].key == key)
-                {
-                    return const_iterator(this, seg_idx, bucket_data.entry_index);
-                }
+                resize_segment(segment, max_capacity);
             }
 
-            current_pos = (current_pos + 1) % capacity;
-            ++distance;
-        }
-
-        return end();
-    }
-
-    bool insert(const Key &key, const Value &value)
-    {
-        size_t seg_idx = get_segment_index(key);
-        auto &segment = segments_[seg_idx];
-
-        std::shared_lock<std::shared_mutex> lock(segment->mutex);
-
-        if (find(key) != end())
-        {
-            return false;
-        }
-
-        size_t current_size = segment->size.load();
-        size_t current_capacity = segment->capacity.load();
-
-        if (current_size >= current_capacity * MAX_LOAD_FACTOR)
-        {
-            lock.unlock();
-            std::unique_lock<std::shared_mutex> exclusive_lock(segment->mutex);
-
-            if (segment->size.load() >= segment->capacity.load() * MAX_LOAD_FACTOR)
+            // A probe run past MAX_DISTANCE means the segment is badly
+            // clustered, and doubling it spreads the run. Only keys that
+            // share most of their hash bits survive several doublings.
+            while (!insert_in_segment(segment, key, value, hash))
             {
-                resize_segment(*segment);
+                if (segment.capacity.load() >= max_capacity || !resize_segment(segment, max_capacity))
+                    throw std::length_error("concurrent_unordered_dense_map: too many keys share a hash");
             }
-
-            exclusive_lock.unlock();
-            lock = std::shared_lock<std::shared_mutex>(segment->mutex);
+            return true;
         }
-
-        return insert_in_segment(*segment, key, value);
     }
 
     bool erase(const Key &key)
     {
-        size_t seg_idx = get_segment_index(key);
-        auto &segment = segments_[seg_idx];
+        return erase_hashed(key, Hash::hash(key));
+    }
 
-        std::shared_lock<std::shared_mutex> lock(segment->mutex);
+    bool erase_hashed(const Key &key, uint64_t hash)
+    {
+        std::unique_lock<std::shared_mutex> lock;
+        Segment &segment = lock_segment(hash, lock);
 
-        auto it = find(key);
-        if (it == end())
+        size_t entry_idx = find_in_segment(segment, key, hash);
+        if (entry_idx == npos)
         {
             return false;
         }
 
-        Entry *entries = segment->entries.load();
-        entries[it.entry_idx_].valid.store(false, std::memory_order_release);
+        Entry *entries = segment.entries.load();
+        entries[entry_idx].valid.store(false, std::memory_order_release);
 
-        size_t capacity = segment->capacity.load();
-        uint64_t hash = Hash::hash(key);
-        uint8_t fingerprint = Hash::fingerprint(key);
-        size_t ideal_pos = hash % capacity;
-        size_t current_pos = ideal_pos;
+        uint8_t fingerprint = detail::fingerprint_of(hash);
+        size_t capacity = segment.capacity.load();
+        size_t current_pos = hash % capacity;
         size_t distance = 0;
 
         while (distance < MAX_DISTANCE)
         {
-            auto bucket = &segment->buckets[current_pos];
+            auto bucket = &segment.bucket(current_pos);
             auto bucket_data = bucket->unpack();
 
             if (bucket_data.is_occupied() &&
                 bucket_data.fingerprint == fingerprint &&
-                bucket_data.entry_index == it.entry_idx_)
+                bucket_data.entry_index == entry_idx)
             {
-                uint64_t tombstone_data = AtomicBucket::pack(fingerprint, bucket_data.distance, false, true, bucket_data.entry_index);
-                uint64_t expected = bucket->data.load();
-                bucket->compare_exchange_weak(expected, tombstone_data);
+                bucket->store(AtomicBucket::pack(fingerprint, bucket_data.distance, false, true, bucket_data.entry_index));
                 break;
             }
 
@@ -323,6 +396,24 @@ public:
         return true;
     }
 
+    // Pulls the home bucket of hash into cache ahead of a find_hashed. It is
+    // only a hint and takes no lock: directories and segments outlive every
+    // operation, and the capacity is loaded before the bucket array, which
+    // resize publishes first, so the index stays inside the array loaded. A
+    // resize or split racing with it just makes the hint useless: the array
+    // may already be freed, and a prefetch of it never faults.
+    void prefetch(uint64_t hash) const
+    {
+        const Directory *directory = directory_.load(std::memory_order_acquire);
+        const Segment *segment = directory->slots[directory->index(hash)].load(std::memory_order_acquire);
+        const size_t capacity = segment->capacity.load(std::memory_order_acquire);
+        const AtomicBucket *buckets = segment->buckets.load(std::memory_order_acquire);
+        if (capacity != 0 && buckets)
+        {
+            detail::prefetch(buckets + hash % capacity);
+        }
+    }
+
     size_type size() const
     {
         return total_size_.load(std::memory_order_acquire);
@@ -333,10 +424,30 @@ public:
         return size() == 0;
     }
 
+    // Number of distinct segments currently in the directory.
+    size_t segment_count() const
+    {
+        std::lock_guard<std::mutex> split_lock(split_mutex_);
+        const Directory &directory = *directory_.load(std::memory_order_acquire);
+        size_t count = 0;
+        for (size_t i = 0; i < directory.slots.size();
+             i += size_t(1) << (directory.global_depth - directory.slots[i].load(std::memory_order_acquire)->local_depth))
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    size_t global_depth() const
+    {
+        return directory_.load(std::memory_order_acquire)->global_depth;
+    }
+
     const_iterator begin() const
     {
         const_iterator it(this, 0, 0);
-        if (segments_[0]->size.load() == 0 || !segments_[0]->entries.load()[0].valid.load())
+        const Segment *first = directory_.load(std::memory_order_acquire)->slots[0].load(std::memory_order_acquire);
+        if (first->size.load() == 0 || !first->entries.load()[0].valid.load())
         {
             ++it;
         }
@@ -345,78 +456,263 @@ public:
 
     const_iterator end() const
     {
-        return const_iterator(this, SEGMENT_COUNT, 0);
+        return const_iterator(this, npos, 0);
     }
 
 private:
-    void resize_segment(Segment &segment)
+    // Caller must hold the segment mutex (either side).
+    size_t find_in_segment(const Segment &segment, const Key &key, uint64_t hash) const
     {
-        size_t old_capacity = segment.capacity.load();
-        size_t new_capacity = old_capacity * 2;
+        uint8_t fingerprint = detail::fingerprint_of(hash);
 
-        auto new_buckets = std::make_unique<AtomicBucket[]>(new_capacity);
-        Entry *new_entries = new Entry[new_capacity];
+        size_t capacity = segment.capacity.load();
+        size_t current_pos = hash % capacity;
+        size_t distance = 0;
+
+        while (distance < MAX_DISTANCE)
+        {
+            auto bucket_data = segment.bucket(current_pos).unpack();
+
+            if (bucket_data.is_empty())
+            {
+                break;
+            }
 
+            if (bucket_data.is_occupied() && bucket_data.fingerprint == fingerprint)
+            {
+                const Entry *entries = segment.entries.load();
+                if (bucket_data.entry_index < segment.size.load() &&
+                    entries[bucket_data.entry_index].valid.load() &&
+                    entries[bucket_data.entry_index].key == key)
+                {
+                    return bucket_data.entry_index;
+                }
+            }
+
+            current_pos = (current_pos + 1) % capacity;
+            ++distance;
+        }
+
+        return npos;
+    }
+
+    void split_segment(uint64_t hash)
+    {
+        std::lock_guard<std::mutex> split_lock(split_mutex_);
+        Directory *directory = directory_.load(std::memory_order_relaxed);
+        const size_t index = directory->index(hash);
+        Segment *old = directory->slots[index].load(std::memory_order_relaxed);
+        std::unique_lock<std::shared_mutex> lock(old->mutex);
+
+        // Another writer may have split it while we waited for the lock
+        if (old->size.load() < SEGMENT_SPLIT_THRESHOLD || old->local_depth >= MAX_GLOBAL_DEPTH || old->unsplittable)
+        {
+            return;
+        }
+
+        // Sort live entries by the new distinguishing bit, keeping each hash
+        // for the index build
+        size_t new_depth = old->local_depth + 1;
+        size_t split_shift = 64 - new_depth;
+        Entry *old_entries = old->entries.load();
+        size_t old_size = old->size.load();
+        std::vector<size_t> sources[2];
+        std::vector<uint64_t> hashes[2];
+        for (size_t i = 0; i < old_size; ++i)
+        {
+            if (old_entries[i].valid.load())
+            {
+                uint64_t entry_hash = Hash::hash(old_entries[i].key);
+                size_t side = (entry_hash >> split_shift) & 1;
+                sources[side].push_back(i);
+                hashes[side].push_back(entry_hash);
+            }
+        }
+
+        // Index both halves before touching the old segment, so a half too
+        // clustered to index leaves it intact
+        std::unique_ptr<AtomicBucket[]> indexes[2];
+        size_t capacities[2];
+        for (int side = 0; side < 2; ++side)
+        {
+            size_t capacity = INITIAL_CAPACITY;
+            while (hashes[side].size() >= capacity * MAX_LOAD_FACTOR)
+            {
+                capacity *= 2;
+            }
+            indexes[side] = build_index(hashes[side], capacity, capacity << MAX_CLUSTER_RESIZES);
+            if (!indexes[side])
+            {
+                old->unsplittable = true;
+                return;
+            }
+            capacities[side] = capacity;
+        }
+
+        Segment *halves[2];
+        for (int side = 0; side < 2; ++side)
+        {
+            segments_.push_back(std::make_unique<Segment>(capacities[side], new_depth));
+            Segment &half = *segments_.back();
+            delete[] half.buckets.exchange(indexes[side].release());
+            Entry *entries = half.entries.load();
+            for (size_t j = 0; j < sources[side].size(); ++j)
+            {
+                entries[j].key = std::move(old_entries[sources[side][j]].key);
+                entries[j].value = std::move(old_entries[sources[side][j]].value);
+                entries[j].valid.store(true);
+            }
+            half.size.store(sources[side].size());
+            halves[side] = &half;
+        }
+
+        if (old->local_depth == directory->global_depth)
+        {
+            // The old segment had one slot; the doubled directory gives each
+            // half one of the two that replace it
+            auto doubled = std::make_unique<Directory>(directory->global_depth + 1);
+            for (size_t i = 0; i < directory->slots.size(); ++i)
+            {
+                Segment *segment = directory->slots[i].load(std::memory_order_relaxed);
+                doubled->slots[2 * i].store(segment == old ? halves[0] : segment, std::memory_order_relaxed);
+                doubled->slots[2 * i + 1].store(segment == old ? halves[1] : segment, std::memory_order_relaxed);
+            }
+            directory_.store(doubled.get(), std::memory_order_release);
+            directories_.push_back(std::move(doubled));
+        }
+        else
+        {
+            // Repoint the slots that referenced the old segment
+            size_t span = size_t(1) << (directory->global_depth - old->local_depth);
+            size_t first = (index / span) * span;
+            for (size_t i = 0; i < span; ++i)
+            {
+                directory->slots[first + i].store(halves[i < span / 2 ? 0 : 1], std::memory_order_release);
+            }
+        }
+
+        // Anyone still waiting on the old lock retries through the directory
+        old->retired = true;
+        old->capacity.store(0);
+        delete[] old->buckets.exchange(nullptr);
+        delete[] old->entries.exchange(nullptr);
+        old->size.store(0);
+    }
+
+    // Compacts the live entries into a segment of at least twice the
+    // capacity and rebuilds its index. False, leaving the segment as it was,
+    // when no capacity up to max_capacity indexes every entry.
+    bool resize_segment(Segment &segment, size_t max_capacity)
+    {
         Entry *old_entries = segment.entries.load();
         size_t old_size = segment.size.load();
-        size_t new_size = 0;
-
+        std::vector<size_t> sources;
+        std::vector<uint64_t> hashes;
         for (size_t i = 0; i < old_size; ++i)
         {
             if (old_entries[i].valid.load())
             {
-                new_entries[new_size].key = std::move(old_entries[i].key);
-                new_entries[new_size].value = std::move(old_entries[i].value);
-                new_entries[new_size].valid.store(true);
-                ++new_size;
+                sources.push_back(i);
+                hashes.push_back(Hash::hash(old_entries[i].key));
             }
         }
 
-        Entry *old_entries_ptr = segment.entries.exchange(new_entries);
-        segment.buckets = std::move(new_buckets);
-        segment.capacity.store(new_capacity);
-        segment.size.store(new_size);
+        size_t new_capacity = segment.capacity.load() * 2;
+        auto new_buckets = build_index(hashes, new_capacity, max_capacity);
+        if (!new_buckets)
+        {
+            return false;
+        }
+
+        Entry *new_entries = new Entry[new_capacity];
+        for (size_t i = 0; i < sources.size(); ++i)
+        {
+            new_entries[i].key = std::move(old_entries[sources[i]].key);
+            new_entries[i].value = std::move(old_entries[sources[i]].value);
+            new_entries[i].valid.store(true);
+        }
+
+        // The buckets go in before the capacity, so a prefetch that sees the
+        // new capacity also sees the new array
+        delete[] segment.entries.exchange(new_entries);
+        delete[] segment.buckets.exchange(new_buckets.release());
+        segment.capacity.store(new_capacity, std::memory_order_release);
+        segment.entries_capacity.store(new_capacity);
+        segment.size.store(sources.size());
+        return true;
+    }
+
+    // Index mapping entry i to hashes[i], at the first capacity from
+    // capacity up to max_capacity (doubling) where every entry lands within
+    // MAX_DISTANCE of its home, which is as far as lookups probe. Null if
+    // none does; capacity holds the one used.
+    static std::unique_ptr<AtomicBucket[]> build_index(const std::vector<uint64_t> &hashes, size_t &capacity,
+                                                       size_t max_capacity)
+    {
+        for (; capacity <= max_capacity; capacity *= 2)
+        {
+            auto buckets = std::make_unique<AtomicBucket[]>(capacity);
+            bool placed = true;
+            for (size_t i = 0; placed && i < hashes.size(); ++i)
+            {
+                placed = place_in_buckets(buckets.get(), capacity, hashes[i], i);
+            }
+            if (placed)
+            {
+                return buckets;
+            }
+        }
+        return nullptr;
+    }
 
-        delete[] old_entries_ptr;
+    static bool place_in_buckets(AtomicBucket *buckets, size_t capacity, uint64_t hash, size_t entry_idx)
+    {
+        size_t current_pos = hash % capacity;
+        for (size_t distance = 0; distance < MAX_DISTANCE; ++distance)
+        {
+            if (buckets[current_pos].unpack().is_empty())
+            {
+                buckets[current_pos].store(AtomicBucket::pack(detail::fingerprint_of(hash), static_cast<uint8_t>(distance), true, false, entry_idx));
+                return true;
+            }
+            current_pos = (current_pos + 1) % capacity;
+        }
+        return false;
     }
 
-    bool insert_in_segment(Segment &segment, const Key &key, const Value &value)
+    // Caller must hold the segment mutex exclusively. False when the entry
+    // array is full or no free bucket lies within MAX_DISTANCE of the home
+    // position.
+    bool insert_in_segment(Segment &segment, const Key &key, const Value &value, uint64_t hash)
     {
-        uint64_t hash = Hash::hash(key);
-        uint8_t fingerprint = Hash::fingerprint(key);
+        if (segment.size.load() == segment.entries_capacity.load())
+        {
+            return false;
+        }
+        uint8_t fingerprint = detail::fingerprint_of(hash);
 
         size_t capacity = segment.capacity.load();
-        size_t ideal_pos = hash % capacity;
-        size_t current_pos = ideal_pos;
+        size_t current_pos = hash % capacity;
         size_t distance = 0;
 
         while (distance < MAX_DISTANCE)
         {
-            auto bucket = &segment.buckets[current_pos];
+            auto bucket = &segment.bucket(current_pos);
             auto bucket_data = bucket->unpack();
 
             if (bucket_data.is_empty() || bucket_data.is_tombstone())
             {
-                size_t entry_idx = segment.size.fetch_add(1, std::memory_order_acq_rel);
+                size_t entry_idx = segment.size.load();
 
                 Entry *entries = segment.entries.load();
                 entries[entry_idx].key = key;
                 entries[entry_idx].value = value;
                 entries[entry_idx].valid.store(true);
 
-                uint64_t new_bucket_data = AtomicBucket::pack(fingerprint, distance, true, false, entry_idx);
-                uint64_t expected = bucket->data.load();
-
-                if (bucket->compare_exchange_weak(expected, new_bucket_data))
-                {
-                    total_size_.fetch_add(1, std::memory_order_acq_rel);
-                    return true;
-                }
-                else
-                {
-                    segment.size.fetch_sub(1, std::memory_order_acq_rel);
-                    entries[entry_idx].valid.store(false);
-                }
+                bucket->store(AtomicBucket::pack(fingerprint, distance, true, false, entry_idx));
+                segment.size.store(entry_idx + 1, std::memory_order_release);
+                total_size_.fetch_add(1, std::memory_order_acq_rel);
+                return true;
             }
 
             current_pos = (current_pos + 1) % capacity;
@@ -425,4 +721,4 @@ private:
 
         return false;
     }
-};
\ No newline at end of file
+};
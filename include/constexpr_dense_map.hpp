@@ -0,0 +1,201 @@
+#pragma once
+
+#include "unordered_dense_map.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace detail
+{
+    // splitmix64 finalizer: every input bit reaches both the low bits used
+    // for positions and the high bits used for fingerprints.
+    constexpr uint64_t constexpr_mix(uint64_t x)
+    {
+        x += 0x9E3779B97F4A7C15ull;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+        return x ^ (x >> 31);
+    }
+
+    // Hash usable in constant expressions, for integral, enum and string
+    // keys. Strings are folded with FNV-1a before the final mix.
+    template <typename T>
+    struct constexpr_hash
+    {
+        static constexpr uint64_t hash(const T &key)
+        {
+            if constexpr (std::is_convertible_v<const T &, std::string_view>)
+            {
+                uint64_t h = 0xCBF29CE484222325ull;
+                for (char c : std::string_view(key))
+                {
+                    h = (h ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+                }
+                return constexpr_mix(h);
+            }
+            else
+            {
+                static_assert(std::is_integral_v<T> || std::is_enum_v<T>,
+                              "constexpr_hash supports integral, enum and string keys");
+                return constexpr_mix(static_cast<uint64_t>(key));
+            }
+        }
+    };
+}
+
+// Immutable map built entirely in a constant expression, for static keyword
+// and opcode tables: declared constexpr, the entries and the robin-hood
+// bucket index are computed by the compiler and placed in read-only data, so
+// there is no startup work. Buckets are the same detail::Bucket records as in
+// unordered_dense_map, with the same detail::fingerprint_of, sized to a power
+// of two at most 3/4 full, and find() stops at the longest probe the build
+// produced. Positions come straight from the hash: detail::probe_hash remixes
+// with a function that is not constexpr, and Hash must mix every bit anyway.
+//
+// Hash must provide a constexpr static hash(const Key &). A duplicate key or
+// a probe run past 255 buckets fails the build.
+template <typename Key, typename Value, size_t N, typename Hash = detail::constexpr_hash<Key>>
+class constexpr_dense_map
+{
+public:
+    struct Entry
+    {
+        Key key;
+        Value value;
+    };
+
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = Entry;
+    using size_type = size_t;
+    using const_iterator = const Entry *;
+
+    static constexpr size_t CAPACITY = std::bit_ceil(N + N / 3 + 1);
+
+private:
+    static constexpr size_t MASK = CAPACITY - 1;
+    static constexpr size_t MAX_DISTANCE = 255;
+
+    std::array<Entry, N> entries_; // In declaration order
+    std::array<detail::Bucket, CAPACITY> buckets_{};
+    size_t max_distance_ = 0;
+
+public:
+    constexpr explicit constexpr_dense_map(const std::pair<Key, Value> (&items)[N])
+        : constexpr_dense_map(items, std::make_index_sequence<N>{}) {}
+    constexpr explicit constexpr_dense_map(const std::array<std::pair<Key, Value>, N> &items)
+        : constexpr_dense_map(items, std::make_index_sequence<N>{}) {}
+
+    constexpr size_type size() const { return N; }
+    constexpr bool empty() const { return N == 0; }
+    constexpr size_type bucket_count() const { return CAPACITY; }
+
+    constexpr const_iterator begin() const { return entries_.data(); }
+    constexpr const_iterator end() const { return entries_.data() + N; }
+
+    // Pointer to the value of key, or nullptr.
+    constexpr const Value *find(const Key &key) const
+    {
+        const size_t index = find_index(key, Hash::hash(key));
+        return index == N ? nullptr : &entries_[index].value;
+    }
+
+    // These work from the entry index rather than comparing find()'s pointer
+    // with nullptr, which sanitizer builds reject in constant expressions.
+    constexpr bool contains(const Key &key) const { return find_index(key, Hash::hash(key)) != N; }
+    constexpr size_type count(const Key &key) const { return contains(key) ? 1 : 0; }
+
+    constexpr const Value &at(const Key &key) const
+    {
+        const size_t index = find_index(key, Hash::hash(key));
+        if (index == N)
+            throw std::out_of_range("Key not found");
+        return entries_[index].value;
+    }
+
+    // Value of key, or fallback when the key is absent.
+    constexpr Value value_or(const Key &key, Value fallback) const
+    {
+        const size_t index = find_index(key, Hash::hash(key));
+        return index == N ? fallback : entries_[index].value;
+    }
+
+private:
+    template <typename Items, size_t... I>
+    constexpr constexpr_dense_map(const Items &items, std::index_sequence<I...>)
+        : entries_{{Entry{items[I].first, items[I].second}...}}
+    {
+        for (size_t i = 0; i < N; ++i)
+        {
+            const uint64_t hash = Hash::hash(entries_[i].key);
+            if (find_index(entries_[i].key, hash) != N)
+                throw std::invalid_argument("constexpr_dense_map: duplicate key");
+            insert_bucket(hash, i);
+        }
+    }
+
+    // Entry index of key, or N. A run is ordered by distance, so the probe
+    // may also stop at the first bucket that is closer to its home.
+    constexpr size_t find_index(const Key &key, uint64_t hash) const
+    {
+        const uint8_t fingerprint = detail::fingerprint_of(hash);
+        size_t pos = hash & MASK;
+        for (size_t distance = 0; distance <= max_distance_; ++distance)
+        {
+            const detail::Bucket &bucket = buckets_[pos];
+            if (!bucket.is_occupied() || bucket.distance < distance)
+            {
+                return N;
+            }
+            if (bucket.fingerprint == fingerprint && entries_[bucket.entry_index].key == key)
+            {
+                return bucket.entry_index;
+            }
+            pos = (pos + 1) & MASK;
+        }
+        return N;
+    }
+
+    constexpr void insert_bucket(uint64_t hash, size_t index)
+    {
+        detail::Bucket pending;
+        pending.set_occupied(detail::fingerprint_of(hash), 0, index);
+
+        size_t pos = hash & MASK;
+        for (size_t distance = 0; distance <= MAX_DISTANCE; ++distance)
+        {
+            detail::Bucket &bucket = buckets_[pos];
+            if (!bucket.is_occupied())
+            {
+                pending.distance = distance;
+                bucket = pending;
+                max_distance_ = std::max<size_t>(max_distance_, distance);
+                return;
+            }
+            if (bucket.distance < distance)
+            {
+                pending.distance = distance;
+                max_distance_ = std::max<size_t>(max_distance_, distance);
+                distance = bucket.distance;
+                std::swap(bucket, pending);
+            }
+            pos = (pos + 1) & MASK;
+        }
+        throw std::length_error("constexpr_dense_map: probe sequence too long");
+    }
+};
+
+// Builds a constexpr_dense_map in a constant expression; the bound comes from
+// the braced list:
+//   constexpr auto ops = make_constexpr_dense_map<std::string_view, int>({{"add", 1}, {"sub", 2}});
+template <typename Key, typename Value, typename Hash = detail::constexpr_hash<Key>, size_t N>
+consteval auto make_constexpr_dense_map(const std::pair<Key, Value> (&items)[N])
+{
+    return constexpr_dense_map<Key, Value, N, Hash>(items);
+}
@@ -0,0 +1,404 @@
+#pragma once
+
+#include "unordered_dense_map.hpp"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Dense map with a bucketized cuckoo index in place of robin-hood probing,
+// for tables that should run nearly full. Entries are stored densely, as in
+// unordered_dense_map. The index is an array of one-cache-line buckets, each
+// with eight one-byte fingerprints scanned as a single word and the eight
+// matching entry indices. A key lives in one of two buckets: its home, and
+// (mix(fingerprint) - home) mod buckets. A lookup therefore reads at most two
+// index lines before the entry, at any load. An insert into two full buckets
+// evicts residents to their other bucket, which needs no hashing since the
+// fingerprint names it.
+//
+// The index grows by half once it is 95% full, against 75% for robin-hood,
+// and needs no power-of-two size. Storage selects the entry and bucket
+// containers, as for unordered_dense_map. Erase moves the last entry into
+// the hole. At most 2^32 - 1 entries.
+template <typename Key, typename Value, typename Hash = detail::hash_traits<Key>,
+          typename Storage = dense_storage::contiguous>
+class cuckoo_dense_map
+{
+private:
+    static constexpr size_t SLOTS = 8;
+    static constexpr size_t INITIAL_BUCKETS = 2;
+    static constexpr float MAX_LOAD_FACTOR = 0.95f;
+    static constexpr size_t MAX_KICKS = 500;
+
+    struct Entry
+    {
+        Key key;
+        Value value;
+
+        Entry() = default;
+        Entry(const Key &k, const Value &v) : key(k), value(v) {}
+        Entry(Key &&k, Value &&v) : key(std::move(k)), value(std::move(v)) {}
+    };
+
+    struct alignas(64) Bucket
+    {
+        uint64_t fingerprints = 0; // Byte i for slot i; 0 marks an empty slot
+        uint32_t indices[SLOTS] = {};
+    };
+
+    typename Storage::template bucket_container<Bucket> buckets_;
+    typename Storage::template entry_container<Entry> entries_;
+    std::array<uint32_t, 256> mixes_; // Per fingerprint, mix mod bucket count
+    uint64_t kick_state_ = 0;         // LCG choosing the slot to evict
+
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = Entry;
+    using size_type = size_t;
+
+    cuckoo_dense_map() { reset_index(INITIAL_BUCKETS); }
+    cuckoo_dense_map(const cuckoo_dense_map &other) = default;
+    cuckoo_dense_map(cuckoo_dense_map &&other) = default;
+    cuckoo_dense_map &operator=(const cuckoo_dense_map &other) = default;
+    cuckoo_dense_map &operator=(cuckoo_dense_map &&other) = default;
+
+    bool empty() const { return entries_.empty(); }
+    size_type size() const { return entries_.size(); }
+    size_type max_size() const { return std::numeric_limits<uint32_t>::max(); }
+    size_type bucket_count() const { return buckets_.size() * SLOTS; } // Index slots
+    float load_factor() const { return static_cast<float>(size()) / bucket_count(); }
+
+    template <bool IsConst>
+    class basic_iterator
+    {
+    public:
+        using map_pointer = std::conditional_t<IsConst, const cuckoo_dense_map *, cuckoo_dense_map *>;
+        using entry_type = std::conditional_t<IsConst, const Entry, Entry>;
+
+        map_pointer map_;
+        size_t index_;
+
+        basic_iterator(map_pointer map, size_t index) : map_(map), index_(index) {}
+
+        // const_iterator from iterator
+        template <bool OtherConst>
+            requires(IsConst && !OtherConst)
+        basic_iterator(const basic_iterator<OtherConst> &other) : map_(other.map_), index_(other.index_) {}
+
+        entry_type &operator*() const { return map_->entries_[index_]; }
+        entry_type *operator->() const { return &map_->entries_[index_]; }
+
+        basic_iterator &operator++()
+        {
+            ++index_;
+            return *this;
+        }
+        basic_iterator operator++(int)
+        {
+            basic_iterator tmp = *this;
+            ++index_;
+            return tmp;
+        }
+        bool operator==(const basic_iterator &other) const { return map_ == other.map_ && index_ == other.index_; }
+        bool operator!=(const basic_iterator &other) const { return !(*this == other); }
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    Value &operator[](const Key &key)
+    {
+        auto [it, inserted] = try_emplace(key);
+        return it->value;
+    }
+
+    Value &at(const Key &key)
+    {
+        auto it = find(key);
+        if (it == end())
+            throw std::out_of_range("Key not found");
+        return it->value;
+    }
+
+    const Value &at(const Key &key) const
+    {
+        auto it = find(key);
+        if (it == end())
+            throw std::out_of_range("Key not found");
+        return it->value;
+    }
+
+    std::pair<iterator, bool> insert(const Key &key, const Value &value) { return try_emplace(key, value); }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args)
+    {
+        return try_emplace_hashed(key, Hash::hash(key), std::forward<Args>(args)...);
+    }
+
+    // Same as try_emplace for callers that already hold Hash::hash(key).
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace_hashed(const Key &key, uint64_t hash, Args &&...args)
+    {
+        const size_t existing = find_index(key, hash);
+        if (existing != npos)
+        {
+            return {iterator(this, existing), false};
+        }
+        if (size() == max_size())
+        {
+            throw std::length_error("cuckoo_dense_map: too many entries");
+        }
+        if (size() >= bucket_count() * MAX_LOAD_FACTOR)
+        {
+            rehash(grown(buckets_.size()));
+        }
+
+        const size_t index = entries_.size();
+        entries_.emplace_back(Key(key), Value(std::forward<Args>(args)...));
+        if (!insert_slot(hash, index))
+        {
+            // The eviction walk gave up; the rebuild places every entry
+            rehash(grown(buckets_.size()));
+        }
+        return {iterator(this, index), true};
+    }
+
+    iterator find(const Key &key) { return find_hashed(key, Hash::hash(key)); }
+    const_iterator find(const Key &key) const { return find_hashed(key, Hash::hash(key)); }
+    iterator find_hashed(const Key &key, uint64_t hash)
+    {
+        const size_t index = find_index(key, hash);
+        return index == npos ? end() : iterator(this, index);
+    }
+    const_iterator find_hashed(const Key &key, uint64_t hash) const
+    {
+        const size_t index = find_index(key, hash);
+        return index == npos ? end() : const_iterator(this, index);
+    }
+    size_type count(const Key &key) const { return contains(key) ? 1 : 0; }
+    bool contains(const Key &key) const { return find_index(key, Hash::hash(key)) != npos; }
+
+    size_type erase(const Key &key) { return erase_hashed(key, Hash::hash(key)); }
+    size_type erase_hashed(const Key &key, uint64_t hash)
+    {
+        const auto [bucket, slot] = find_slot(key, hash);
+        if (bucket == npos)
+        {
+            return 0;
+        }
+        const size_t index = buckets_[bucket].indices[slot];
+        set_fingerprint(buckets_[bucket], slot, 0);
+
+        // Fill the hole with the last entry and repoint its slot, which is
+        // in one of the moved key's two buckets
+        const size_t last = entries_.size() - 1;
+        if (index != last)
+        {
+            entries_[index] = std::move(entries_[last]);
+            const uint64_t moved_hash = Hash::hash(entries_[index].key);
+            const uint8_t fingerprint = fingerprint_of(moved_hash);
+            const size_t home = home_of(moved_hash);
+            if (!repoint(home, fingerprint, last, index))
+            {
+                repoint(alternate_of(home, fingerprint), fingerprint, last, index);
+            }
+        }
+        entries_.pop_back();
+        return 1;
+    }
+
+    void clear()
+    {
+        entries_.clear();
+        reset_index(INITIAL_BUCKETS);
+    }
+
+    // Sizes the index so that count elements fit without a rehash.
+    void reserve(size_type count)
+    {
+        const size_t buckets = static_cast<size_t>(count / (SLOTS * MAX_LOAD_FACTOR)) + 1;
+        if (buckets > buckets_.size())
+        {
+            rehash(buckets);
+        }
+        entries_.reserve(count);
+    }
+
+private:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+    static constexpr uint64_t LOW_BITS = 0x0101010101010101ull;
+    static constexpr uint64_t LOW_SEVEN = 0x7F7F7F7F7F7F7F7Full;
+
+    // Zero marks an empty slot, so the shared fingerprint 0 is folded into 1
+    static uint8_t fingerprint_of(uint64_t hash)
+    {
+        const uint8_t fingerprint = detail::fingerprint_of(hash);
+        return fingerprint == 0 ? 1 : fingerprint;
+    }
+
+    static size_t grown(size_t buckets) { return buckets + buckets / 2; }
+
+    // High bit of each byte of word that is zero, exactly: no borrow
+    // crosses bytes, so a match never flags its neighbour.
+    static uint64_t zero_bytes(uint64_t word)
+    {
+        return ~(((word & LOW_SEVEN) + LOW_SEVEN) | word | LOW_SEVEN);
+    }
+
+    static void set_fingerprint(Bucket &bucket, size_t slot, uint8_t fingerprint)
+    {
+        bucket.fingerprints = (bucket.fingerprints & ~(0xFFull << (slot * 8))) | (uint64_t(fingerprint) << (slot * 8));
+    }
+
+    size_t home_of(uint64_t hash) const
+    {
+        return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(hash)) * buckets_.size()) >> 32);
+    }
+
+    // (mix - b) mod m maps each of a key's two buckets to the other
+    size_t alternate_of(size_t bucket, uint8_t fingerprint) const
+    {
+        const size_t mix = mixes_[fingerprint];
+        return mix >= bucket ? mix - bucket : mix + buckets_.size() - bucket;
+    }
+
+    void reset_index(size_t bucket_count)
+    {
+        buckets_.clear();
+        buckets_.resize(bucket_count);
+        for (size_t fingerprint = 0; fingerprint < 256; ++fingerprint)
+        {
+            mixes_[fingerprint] = static_cast<uint32_t>((fingerprint * 0x5BD1E995ull) % bucket_count);
+        }
+    }
+
+    // Slot in bucket whose fingerprint matches and whose entry holds key
+    size_t match_in(size_t bucket, uint8_t fingerprint, const Key &key) const
+    {
+        const Bucket &b = buckets_[bucket];
+        for (uint64_t matches = zero_bytes(b.fingerprints ^ (fingerprint * LOW_BITS)); matches != 0;
+             matches &= matches - 1)
+        {
+            const size_t slot = static_cast<size_t>(std::countr_zero(matches)) / 8;
+            if (entries_[b.indices[slot]].key == key)
+            {
+                return slot;
+            }
+        }
+        return npos;
+    }
+
+    std::pair<size_t, size_t> find_slot(const Key &key, uint64_t hash) const
+    {
+        const uint8_t fingerprint = fingerprint_of(hash);
+        const size_t home = home_of(hash);
+        if (const size_t slot = match_in(home, fingerprint, key); slot != npos)
+        {
+            return {home, slot};
+        }
+        const size_t alternate = alternate_of(home, fingerprint);
+        if (const size_t slot = match_in(alternate, fingerprint, key); slot != npos)
+        {
+            return {alternate, slot};
+        }
+        return {npos, 0};
+    }
+
+    size_t find_index(const Key &key, uint64_t hash) const
+    {
+        const auto [bucket, slot] = find_slot(key, hash);
+        return bucket == npos ? npos : buckets_[bucket].indices[slot];
+    }
+
+    bool repoint(size_t bucket, uint8_t fingerprint, size_t from, size_t to)
+    {
+        Bucket &b = buckets_[bucket];
+        for (uint64_t matches = zero_bytes(b.fingerprints ^ (fingerprint * LOW_BITS)); matches != 0;
+             matches &= matches - 1)
+        {
+            const size_t slot = static_cast<size_t>(std::countr_zero(matches)) / 8;
+            if (b.indices[slot] == from)
+            {
+                b.indices[slot] = static_cast<uint32_t>(to);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool try_store(size_t bucket, uint8_t fingerprint, size_t index)
+    {
+        Bucket &b = buckets_[bucket];
+        const uint64_t empty = zero_bytes(b.fingerprints);
+        if (empty == 0)
+        {
+            return false;
+        }
+        const size_t slot = static_cast<size_t>(std::countr_zero(empty)) / 8;
+        set_fingerprint(b, slot, fingerprint);
+        b.indices[slot] = static_cast<uint32_t>(index);
+        return true;
+    }
+
+    // Home bucket first, then the alternate, then a random eviction walk.
+    // False leaves one entry without a slot; the caller must rebuild.
+    bool insert_slot(uint64_t hash, size_t index)
+    {
+        uint8_t fingerprint = fingerprint_of(hash);
+        size_t bucket = home_of(hash);
+        if (try_store(bucket, fingerprint, index) || try_store(alternate_of(bucket, fingerprint), fingerprint, index))
+        {
+            return true;
+        }
+
+        for (size_t kick = 0; kick < MAX_KICKS; ++kick)
+        {
+            kick_state_ = kick_state_ * 6364136223846793005ull + 1442695040888963407ull;
+            const size_t slot = static_cast<size_t>(kick_state_ >> 61);
+            Bucket &b = buckets_[bucket];
+            const uint8_t evicted = static_cast<uint8_t>(b.fingerprints >> (slot * 8));
+            const size_t evicted_index = b.indices[slot];
+            set_fingerprint(b, slot, fingerprint);
+            b.indices[slot] = static_cast<uint32_t>(index);
+
+            fingerprint = evicted;
+            index = evicted_index;
+            bucket = alternate_of(bucket, fingerprint);
+            if (try_store(bucket, fingerprint, index))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Rebuilds the index over the entries, growing until every one fits.
+    void rehash(size_t bucket_count)
+    {
+        while (true)
+        {
+            reset_index(bucket_count);
+            bool placed_all = true;
+            for (size_t i = 0; i < entries_.size() && placed_all; ++i)
+            {
+                placed_all = insert_slot(Hash::hash(entries_[i].key), i);
+            }
+            if (placed_all)
+            {
+                return;
+            }
+            bucket_count = grown(bucket_count);
+        }
+    }
+};
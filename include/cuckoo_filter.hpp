@@ -0,0 +1,324 @@
+#pragma once
+
+#include "unordered_dense_map.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Approximate set of keys in about one byte per key: a cuckoo filter of
+// buckets holding four 8-bit fingerprints, the same multiplicative-mix
+// fingerprint unordered_dense_map keeps in its buckets. contains() may report
+// a key that was never inserted (about 3% of absent keys when full) but
+// never misses one that was. A key can live in two buckets, its home and
+// (mix(fingerprint) - home) mod buckets, so an insert into two full buckets
+// evicts a resident fingerprint to its other bucket, and so on. The filter
+// is sized to run 93% full; once the eviction chain gives up, one homeless
+// fingerprint is kept aside and further inserts fail.
+//
+// Inserting the same key twice stores it twice, and erase() must only be
+// given keys that were inserted, or it may remove another key's fingerprint.
+template <typename Key, typename Hash = detail::hash_traits<Key>>
+class cuckoo_filter
+{
+public:
+    using key_type = Key;
+    using size_type = size_t;
+
+    static constexpr float TARGET_LOAD = 0.93f;
+
+    // Room for capacity keys at TARGET_LOAD.
+    explicit cuckoo_filter(size_t capacity)
+        : buckets_(std::max<size_t>(1, static_cast<size_t>(capacity / (SLOTS * TARGET_LOAD)) + 1), 0)
+    {
+        if (buckets_.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+            throw std::length_error("cuckoo_filter: too many buckets");
+        for (size_t fingerprint = 0; fingerprint < 256; ++fingerprint)
+        {
+            mixes_[fingerprint] = static_cast<uint32_t>((fingerprint * 0x5BD1E995ull) % buckets_.size());
+        }
+    }
+
+    // Filter over the keys whose hashes are given, grown as needed so every
+    // insert succeeds. Equal hashes are stored once: the filter cannot tell
+    // their keys apart anyway, and more than two buckets' worth of one
+    // fingerprint could never be placed. Throws std::length_error if the
+    // hashes still do not fit after MAX_GROWTHS larger attempts.
+    static cuckoo_filter from_hashes(std::span<const uint64_t> hashes)
+    {
+        std::vector<uint64_t> distinct(hashes.begin(), hashes.end());
+        std::sort(distinct.begin(), distinct.end());
+        distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+
+        size_t capacity = distinct.size();
+        for (size_t attempt = 0; attempt <= MAX_GROWTHS; ++attempt, capacity += capacity / 16 + 1)
+        {
+            cuckoo_filter filter(capacity);
+            size_t inserted = 0;
+            while (inserted < distinct.size() && filter.insert_hashed(distinct[inserted]))
+            {
+                ++inserted;
+            }
+            if (inserted == distinct.size())
+            {
+                return filter;
+            }
+        }
+        throw std::length_error("cuckoo_filter: hashes do not fit");
+    }
+
+    // The map's buckets keep only positions and fingerprints, not full
+    // hashes, so each key is hashed once here.
+    template <typename Value, typename Storage>
+    static cuckoo_filter from_map(const unordered_dense_map<Key, Value, Hash, Storage> &map)
+    {
+        std::vector<uint64_t> hashes;
+        hashes.reserve(map.size());
+        for (const auto &entry : map)
+        {
+            hashes.push_back(Hash::hash(entry.key));
+        }
+        return from_hashes(hashes);
+    }
+
+    size_type size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    size_type bucket_count() const { return buckets_.size(); }
+    size_t memory_bytes() const { return buckets_.size() * sizeof(uint32_t); }
+
+    bool insert(const Key &key) { return insert_hashed(Hash::hash(key)); }
+    bool erase(const Key &key) { return erase_hashed(Hash::hash(key)); }
+    bool contains(const Key &key) const { return contains_hashed(Hash::hash(key)); }
+
+    // The *_hashed calls take Hash::hash(key) from callers that hold it.
+    // False when the filter is full; the key is then not stored.
+    bool insert_hashed(uint64_t hash)
+    {
+        if (victim_fingerprint_ != 0)
+        {
+            return false;
+        }
+        uint8_t fingerprint = fingerprint_of(hash);
+        size_t bucket = home_of(hash);
+        if (try_store(bucket, fingerprint) || try_store(alternate_of(bucket, fingerprint), fingerprint))
+        {
+            ++size_;
+            return true;
+        }
+
+        // Evict a random slot along one bucket's chain; the last evictee is
+        // stashed
+        for (size_t kick = 0; kick < MAX_KICKS; ++kick)
+        {
+            kick_state_ = kick_state_ * 6364136223846793005ull + 1442695040888963407ull;
+            const size_t slot = static_cast<size_t>(kick_state_ >> 62);
+            const uint8_t evicted = slot_of(buckets_[bucket], slot);
+            buckets_[bucket] = with_slot(buckets_[bucket], slot, fingerprint);
+            fingerprint = evicted;
+            bucket = alternate_of(bucket, fingerprint);
+            if (try_store(bucket, fingerprint))
+            {
+                ++size_;
+                return true;
+            }
+        }
+        victim_fingerprint_ = fingerprint;
+        victim_bucket_ = bucket;
+        ++size_;
+        return true;
+    }
+
+    bool erase_hashed(uint64_t hash)
+    {
+        const uint8_t fingerprint = fingerprint_of(hash);
+        const size_t home = home_of(hash);
+        const size_t alternate = alternate_of(home, fingerprint);
+        if (try_remove(home, fingerprint) || try_remove(alternate, fingerprint))
+        {
+            --size_;
+            // The stash empties back into the space just freed when it can
+            if (victim_fingerprint_ != 0 &&
+                (try_store(victim_bucket_, victim_fingerprint_) ||
+                 try_store(alternate_of(victim_bucket_, victim_fingerprint_), victim_fingerprint_)))
+            {
+                victim_fingerprint_ = 0;
+            }
+            return true;
+        }
+        if (victim_fingerprint_ == fingerprint && (victim_bucket_ == home || victim_bucket_ == alternate))
+        {
+            victim_fingerprint_ = 0;
+            --size_;
+            return true;
+        }
+        return false;
+    }
+
+    bool contains_hashed(uint64_t hash) const
+    {
+        const uint8_t fingerprint = fingerprint_of(hash);
+        const size_t home = home_of(hash);
+        const size_t alternate = alternate_of(home, fingerprint);
+        return has_fingerprint(buckets_[home], fingerprint) || has_fingerprint(buckets_[alternate], fingerprint) ||
+               stashed(fingerprint, home, alternate);
+    }
+
+    template <typename InputIt>
+    std::vector<bool> batch_contains(InputIt first, InputIt last) const
+    {
+        std::vector<uint64_t> hashes;
+        for (; first != last; ++first)
+        {
+            hashes.push_back(Hash::hash(*first));
+        }
+        return batch_contains_hashed(hashes);
+    }
+
+    // Queries in blocks: both buckets of every hash in a block are
+    // prefetched before any is tested, and with AVX2 eight hashes are tested
+    // at a time by gathering their buckets and comparing all 64 slots at once.
+    std::vector<bool> batch_contains_hashed(std::span<const uint64_t> hashes) const
+    {
+        std::vector<bool> results(hashes.size());
+        alignas(32) int32_t homes[BATCH_BLOCK];
+        alignas(32) int32_t alternates[BATCH_BLOCK];
+        alignas(32) uint32_t patterns[BATCH_BLOCK];
+
+        for (size_t block = 0; block < hashes.size(); block += BATCH_BLOCK)
+        {
+            const size_t n = std::min(BATCH_BLOCK, hashes.size() - block);
+            for (size_t j = 0; j < n; ++j)
+            {
+                const uint8_t fingerprint = fingerprint_of(hashes[block + j]);
+                const size_t home = home_of(hashes[block + j]);
+                homes[j] = static_cast<int32_t>(home);
+                alternates[j] = static_cast<int32_t>(alternate_of(home, fingerprint));
+                patterns[j] = fingerprint * 0x01010101u;
+                detail::prefetch(&buckets_[homes[j]]);
+                detail::prefetch(&buckets_[alternates[j]]);
+            }
+
+            size_t j = 0;
+#if defined(__AVX2__)
+            const int *base = reinterpret_cast<const int *>(buckets_.data());
+            for (; j + 8 <= n; j += 8)
+            {
+                const __m256i pattern = _mm256_load_si256(reinterpret_cast<const __m256i *>(patterns + j));
+                const __m256i home_index = _mm256_load_si256(reinterpret_cast<const __m256i *>(homes + j));
+                const __m256i alternate_index = _mm256_load_si256(reinterpret_cast<const __m256i *>(alternates + j));
+                const __m256i home = _mm256_i32gather_epi32(base, home_index, 4);
+                const __m256i alternate = _mm256_i32gather_epi32(base, alternate_index, 4);
+                const uint32_t found = static_cast<uint32_t>(_mm256_movemask_epi8(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(home, pattern), _mm256_cmpeq_epi8(alternate, pattern))));
+                for (size_t lane = 0; lane < 8; ++lane)
+                {
+                    results[block + j + lane] = ((found >> (lane * SLOTS)) & 0xF) != 0;
+                }
+            }
+#endif
+            for (; j < n; ++j)
+            {
+                const uint8_t fingerprint = static_cast<uint8_t>(patterns[j]);
+                results[block + j] = has_fingerprint(buckets_[homes[j]], fingerprint) ||
+                                     has_fingerprint(buckets_[alternates[j]], fingerprint);
+            }
+
+            if (victim_fingerprint_ != 0)
+            {
+                for (size_t k = 0; k < n; ++k)
+                {
+                    if (!results[block + k] && stashed(static_cast<uint8_t>(patterns[k]), homes[k], alternates[k]))
+                    {
+                        results[block + k] = true;
+                    }
+                }
+            }
+        }
+        return results;
+    }
+
+private:
+    static constexpr size_t SLOTS = 4; // One-byte fingerprints per 32-bit bucket
+    static constexpr size_t MAX_KICKS = 1000;
+    static constexpr size_t BATCH_BLOCK = 32;
+    static constexpr size_t MAX_GROWTHS = 64; // from_hashes gives up past about 50x the room
+
+    // Zero marks an empty slot, so the shared fingerprint 0 is folded into 1
+    static uint8_t fingerprint_of(uint64_t hash)
+    {
+        const uint8_t fingerprint = detail::fingerprint_of(hash);
+        return fingerprint == 0 ? 1 : fingerprint;
+    }
+
+    size_t home_of(uint64_t hash) const
+    {
+        return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(hash)) * buckets_.size()) >> 32);
+    }
+
+    // (mix - b) mod m maps each of a key's two buckets to the other, for any
+    // bucket count, so the array need not be a power of two. The mix of each
+    // fingerprint is reduced mod m once, up front.
+    size_t alternate_of(size_t bucket, uint8_t fingerprint) const
+    {
+        const size_t mix = mixes_[fingerprint];
+        return mix >= bucket ? mix - bucket : mix + buckets_.size() - bucket;
+    }
+
+    static uint8_t slot_of(uint32_t bucket, size_t slot) { return static_cast<uint8_t>(bucket >> (slot * 8)); }
+    static uint32_t with_slot(uint32_t bucket, size_t slot, uint8_t fingerprint)
+    {
+        return (bucket & ~(0xFFu << (slot * 8))) | (uint32_t(fingerprint) << (slot * 8));
+    }
+
+    // SWAR: a byte of bucket ^ pattern is zero exactly where a slot matches
+    static bool has_fingerprint(uint32_t bucket, uint8_t fingerprint)
+    {
+        const uint32_t x = bucket ^ (fingerprint * 0x01010101u);
+        return ((x - 0x01010101u) & ~x & 0x80808080u) != 0;
+    }
+
+    bool stashed(uint8_t fingerprint, size_t home, size_t alternate) const
+    {
+        return victim_fingerprint_ == fingerprint && (victim_bucket_ == home || victim_bucket_ == alternate);
+    }
+
+    bool try_store(size_t bucket, uint8_t fingerprint)
+    {
+        for (size_t slot = 0; slot < SLOTS; ++slot)
+        {
+            if (slot_of(buckets_[bucket], slot) == 0)
+            {
+                buckets_[bucket] = with_slot(buckets_[bucket], slot, fingerprint);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool try_remove(size_t bucket, uint8_t fingerprint)
+    {
+        for (size_t slot = 0; slot < SLOTS; ++slot)
+        {
+            if (slot_of(buckets_[bucket], slot) == fingerprint)
+            {
+                buckets_[bucket] = with_slot(buckets_[bucket], slot, 0);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::vector<uint32_t> buckets_;
+    std::array<uint32_t, 256> mixes_;
+    size_t size_ = 0;
+    uint64_t kick_state_ = 0; // LCG choosing the slot to evict
+    uint8_t victim_fingerprint_ = 0; // Nonzero while a fingerprint is stashed
+    size_t victim_bucket_ = 0;
+};
@@ -0,0 +1,515 @@
+#pragma once
+
+#include "unordered_dense_map.hpp"
+#include "chunked_storage.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <exception>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace detail
+{
+    // Owning POSIX file descriptor. The write-ahead log needs fsync, which
+    // std::fstream does not offer.
+    class posix_file
+    {
+    public:
+        posix_file() = default;
+        posix_file(const std::filesystem::path &path, int flags)
+            : path_(path), fd_(::open(path.c_str(), flags | O_CLOEXEC, 0644))
+        {
+            if (fd_ < 0)
+                fail("open");
+        }
+
+        posix_file(posix_file &&other) noexcept
+            : path_(std::move(other.path_)), fd_(std::exchange(other.fd_, -1)) {}
+        posix_file &operator=(posix_file &&other) noexcept
+        {
+            std::swap(path_, other.path_);
+            std::swap(fd_, other.fd_);
+            return *this;
+        }
+        ~posix_file()
+        {
+            if (fd_ >= 0)
+                ::close(fd_);
+        }
+
+        void write_all(const void *data, size_t size)
+        {
+            const char *p = static_cast<const char *>(data);
+            while (size > 0)
+            {
+                ssize_t n = ::write(fd_, p, size);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n < 0)
+                    fail("write");
+                p += n;
+                size -= static_cast<size_t>(n);
+            }
+        }
+
+        // Reads until size bytes or end of file; returns the bytes read.
+        size_t read_up_to(void *data, size_t size)
+        {
+            char *p = static_cast<char *>(data);
+            size_t done = 0;
+            while (done < size)
+            {
+                ssize_t n = ::read(fd_, p + done, size - done);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n < 0)
+                    fail("read");
+                if (n == 0)
+                    break;
+                done += static_cast<size_t>(n);
+            }
+            return done;
+        }
+
+        // Cuts the file back to size bytes; false if that fails.
+        bool try_truncate(size_t size) noexcept
+        {
+            return ::ftruncate(fd_, static_cast<off_t>(size)) == 0;
+        }
+
+        void sync()
+        {
+            if (::fsync(fd_) != 0)
+                fail("fsync");
+        }
+
+        // Makes creates, renames and removes in directory durable.
+        static void sync_directory(const std::filesystem::path &directory)
+        {
+            posix_file(directory, O_RDONLY | O_DIRECTORY).sync();
+        }
+
+    private:
+        [[noreturn]] void fail(const char *what) const
+        {
+            throw std::system_error(errno, std::generic_category(), std::string(what) + " " + path_.string());
+        }
+
+        std::filesystem::path path_;
+        int fd_ = -1;
+    };
+}
+
+// unordered_dense_map made durable by a write-ahead log. Every effective
+// insert, assignment and erase is appended to the current log file; commit()
+// writes the pending records and fsyncs once for the whole group, and also
+// runs automatically every options::group_commit records. A mutation is
+// acknowledged, and survives a crash, once a commit that follows it returns.
+//
+// checkpoint() rotates to a new log file, snapshots the map in O(chunks)
+// through copy-on-write storage, and writes the snapshot to a checkpoint file
+// on a background thread while the map keeps changing. Once the checkpoint
+// is renamed into place, the logs it covers are deleted. Opening a directory
+// loads the checkpoint and replays the newer logs in order; a torn record at
+// the end of a log, from a crash in the middle of a write, ends that log's
+// replay. Checkpoints start by themselves once the log passes
+// options::compact_bytes.
+//
+// Key and Value are logged as raw bytes and must be trivially copyable. The
+// map is owned by one thread, like unordered_dense_map itself.
+template <typename Key, typename Value, typename Hash = detail::hash_traits<Key>>
+class durable_dense_map
+{
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>,
+                  "logged entries are written as raw bytes");
+
+public:
+    using map_type = unordered_dense_map<Key, Value, Hash, dense_storage::copy_on_write<>>;
+    using const_iterator = typename map_type::const_iterator;
+    using size_type = size_t;
+
+    struct options
+    {
+        size_t group_commit = 512;         // Logged mutations per automatic commit
+        size_t compact_bytes = 64u << 20; // Log size that starts a checkpoint; 0 never
+    };
+
+private:
+    static constexpr uint64_t CHECKPOINT_MAGIC = 0x31504B4344455544ull; // "DUEDCKP1"
+    static constexpr uint64_t CHECKSUM_SEED = 0x6C6F67636865636Bull;
+    static constexpr size_t IO_BLOCK = 4096; // Records per checkpoint read or write
+
+    enum class Op : uint64_t
+    {
+        Put = 1,
+        Erase = 2
+    };
+
+    struct LogRecord
+    {
+        uint64_t checksum; // Of every byte after this field
+        Op op;
+        Key key;
+        Value value;
+    };
+
+    struct CheckpointHeader
+    {
+        uint64_t magic;
+        uint64_t generation; // First log not contained in the checkpoint
+        uint64_t count;
+    };
+
+    struct CheckpointRecord
+    {
+        Key key;
+        Value value;
+    };
+
+    std::filesystem::path directory_;
+    options options_;
+    map_type map_;
+    detail::posix_file log_;
+    uint64_t generation_ = 0; // Number of the log being appended to
+    size_t log_bytes_ = 0;
+    std::vector<LogRecord> pending_;
+
+    std::thread compactor_;
+    std::atomic<bool> compactor_done_{false};
+    std::exception_ptr compactor_error_;
+
+public:
+    // Opens or creates the map stored in directory.
+    explicit durable_dense_map(std::filesystem::path directory, options opts = options{})
+        : directory_(std::move(directory)), options_(opts)
+    {
+        std::filesystem::create_directories(directory_);
+        recover();
+    }
+
+    durable_dense_map(const durable_dense_map &) = delete;
+    durable_dense_map &operator=(const durable_dense_map &) = delete;
+
+    // Commits what is pending and waits for a running checkpoint. Errors are
+    // swallowed here; call commit() and wait_for_checkpoint() to see them.
+    ~durable_dense_map()
+    {
+        try
+        {
+            commit();
+        }
+        catch (...)
+        {
+        }
+        if (compactor_.joinable())
+        {
+            compactor_.join();
+        }
+    }
+
+    const map_type &map() const { return map_; }
+    bool empty() const { return map_.empty(); }
+    size_type size() const { return map_.size(); }
+    const_iterator find(const Key &key) const { return map_.find(key); }
+    const_iterator end() const { return map_.end(); }
+    bool contains(const Key &key) const { return map_.contains(key); }
+    const Value &at(const Key &key) const { return map_.at(key); }
+
+    // Same as unordered_dense_map::insert: an existing key keeps its value.
+    bool insert(const Key &key, const Value &value)
+    {
+        if (!map_.try_emplace(key, value).second)
+        {
+            return false;
+        }
+        append(Op::Put, key, value);
+        return true;
+    }
+
+    void insert_or_assign(const Key &key, const Value &value)
+    {
+        auto [it, inserted] = map_.try_emplace(key, value);
+        if (!inserted)
+        {
+            it->value = value;
+        }
+        append(Op::Put, key, value);
+    }
+
+    size_type erase(const Key &key)
+    {
+        if (map_.erase(key) == 0)
+        {
+            return 0;
+        }
+        append(Op::Erase, key, Value{});
+        return 1;
+    }
+
+    // Group commit: one write and one fsync for every pending record.
+    void commit()
+    {
+        if (!write_pending())
+        {
+            return;
+        }
+        if (options_.compact_bytes != 0 && log_bytes_ >= options_.compact_bytes &&
+            (!compactor_.joinable() || compactor_done_.load(std::memory_order_acquire)))
+        {
+            checkpoint();
+        }
+    }
+
+    // Commits, switches to a new log and writes a checkpoint of the current
+    // contents in the background. Waits for the previous checkpoint first.
+    void checkpoint()
+    {
+        write_pending();
+        wait_for_checkpoint();
+
+        open_log(generation_ + 1);
+        compactor_done_.store(false, std::memory_order_relaxed);
+        compactor_ = std::thread([this, snapshot = map_.snapshot(), generation = generation_]()
+                                 {
+            try
+            {
+                write_checkpoint(snapshot, generation);
+            }
+            catch (...)
+            {
+                compactor_error_ = std::current_exception();
+            }
+            compactor_done_.store(true, std::memory_order_release); });
+    }
+
+    // Joins a running checkpoint and rethrows its error, if any.
+    void wait_for_checkpoint()
+    {
+        if (compactor_.joinable())
+        {
+            compactor_.join();
+        }
+        if (compactor_error_)
+        {
+            std::rethrow_exception(std::exchange(compactor_error_, nullptr));
+        }
+    }
+
+    size_t log_bytes() const { return log_bytes_ + pending_.size() * sizeof(LogRecord); }
+
+private:
+    std::filesystem::path checkpoint_path() const { return directory_ / "checkpoint"; }
+    std::filesystem::path log_path(uint64_t generation) const
+    {
+        return directory_ / ("wal." + std::to_string(generation));
+    }
+
+    static uint64_t checksum(const LogRecord &record)
+    {
+        const char *bytes = reinterpret_cast<const char *>(&record) + sizeof(record.checksum);
+        return detail::WyHash::hash(bytes, sizeof(LogRecord) - sizeof(record.checksum), CHECKSUM_SEED);
+    }
+
+    bool write_pending()
+    {
+        if (pending_.empty())
+        {
+            return false;
+        }
+        const size_t bytes = pending_.size() * sizeof(LogRecord);
+        try
+        {
+            log_.write_all(pending_.data(), bytes);
+            log_.sync();
+        }
+        catch (...)
+        {
+            // The records stay pending for the next commit. Part of them may
+            // have reached the file, so it is cut back to the committed
+            // records; failing that, the retry goes to a fresh log, since
+            // replay stops at this one's torn tail.
+            if (!log_.try_truncate(log_bytes_))
+            {
+                open_log(generation_ + 1);
+            }
+            throw;
+        }
+        log_bytes_ += bytes;
+        pending_.clear();
+        return true;
+    }
+
+    void append(Op op, const Key &key, const Value &value)
+    {
+        LogRecord record{}; // Zeroed padding keeps the checksum deterministic
+        record.op = op;
+        record.key = key;
+        record.value = value;
+        record.checksum = checksum(record);
+        pending_.push_back(record);
+        if (pending_.size() >= options_.group_commit)
+        {
+            commit();
+        }
+    }
+
+    void open_log(uint64_t generation)
+    {
+        log_ = detail::posix_file(log_path(generation), O_WRONLY | O_CREAT | O_EXCL | O_APPEND);
+        detail::posix_file::sync_directory(directory_);
+        generation_ = generation;
+        log_bytes_ = 0;
+    }
+
+    // Log generations present in the directory, ascending.
+    std::vector<uint64_t> log_generations() const
+    {
+        std::vector<uint64_t> generations;
+        for (const auto &file : std::filesystem::directory_iterator(directory_))
+        {
+            const std::string name = file.path().filename().string();
+            uint64_t generation = 0;
+            if (name.rfind("wal.", 0) == 0 &&
+                std::from_chars(name.data() + 4, name.data() + name.size(), generation).ec == std::errc{})
+            {
+                generations.push_back(generation);
+            }
+        }
+        std::sort(generations.begin(), generations.end());
+        return generations;
+    }
+
+    void recover()
+    {
+        std::filesystem::remove(directory_ / "checkpoint.tmp");
+
+        uint64_t first_live = 0;
+        if (std::filesystem::exists(checkpoint_path()))
+        {
+            first_live = load_checkpoint();
+        }
+
+        uint64_t next = first_live;
+        for (uint64_t generation : log_generations())
+        {
+            if (generation < first_live)
+            {
+                // Left behind by a crash after the checkpoint was renamed
+                std::filesystem::remove(log_path(generation));
+                continue;
+            }
+            replay(generation);
+            next = generation + 1;
+        }
+
+        // Appending to a fresh log never lands after a torn record
+        open_log(next);
+    }
+
+    uint64_t load_checkpoint()
+    {
+        detail::posix_file in(checkpoint_path(), O_RDONLY);
+        CheckpointHeader header{};
+        if (in.read_up_to(&header, sizeof(header)) != sizeof(header) || header.magic != CHECKPOINT_MAGIC)
+        {
+            throw std::runtime_error("durable_dense_map: corrupt checkpoint in " + directory_.string());
+        }
+
+        map_.reserve(header.count);
+        std::vector<CheckpointRecord> block(IO_BLOCK);
+        for (uint64_t remaining = header.count; remaining != 0;)
+        {
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(remaining, IO_BLOCK));
+            if (in.read_up_to(block.data(), n * sizeof(CheckpointRecord)) != n * sizeof(CheckpointRecord))
+            {
+                throw std::runtime_error("durable_dense_map: truncated checkpoint in " + directory_.string());
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                map_.try_emplace(block[i].key, block[i].value);
+            }
+            remaining -= n;
+        }
+        return header.generation;
+    }
+
+    void replay(uint64_t generation)
+    {
+        detail::posix_file in(log_path(generation), O_RDONLY);
+        std::vector<LogRecord> block(IO_BLOCK);
+        while (true)
+        {
+            const size_t bytes = in.read_up_to(block.data(), block.size() * sizeof(LogRecord));
+            const size_t n = bytes / sizeof(LogRecord);
+            for (size_t i = 0; i < n; ++i)
+            {
+                const LogRecord &record = block[i];
+                if (record.checksum != checksum(record))
+                {
+                    return; // Torn write; nothing after it was acknowledged
+                }
+                if (record.op == Op::Put)
+                {
+                    auto [it, inserted] = map_.try_emplace(record.key, record.value);
+                    if (!inserted)
+                    {
+                        it->value = record.value;
+                    }
+                }
+                else
+                {
+                    map_.erase(record.key);
+                }
+            }
+            if (bytes != block.size() * sizeof(LogRecord))
+            {
+                return;
+            }
+        }
+    }
+
+    // Runs on the compactor thread and only reads the snapshot and the paths.
+    void write_checkpoint(const map_type &snapshot, uint64_t generation) const
+    {
+        const auto temporary = directory_ / "checkpoint.tmp";
+        {
+            detail::posix_file out(temporary, O_WRONLY | O_CREAT | O_TRUNC);
+            CheckpointHeader header{CHECKPOINT_MAGIC, generation, snapshot.size()};
+            out.write_all(&header, sizeof(header));
+
+            std::vector<CheckpointRecord> block;
+            block.reserve(IO_BLOCK);
+            for (const auto &entry : snapshot)
+            {
+                block.push_back({entry.key, entry.value});
+                if (block.size() == IO_BLOCK)
+                {
+                    out.write_all(block.data(), block.size() * sizeof(CheckpointRecord));
+                    block.clear();
+                }
+            }
+            out.write_all(block.data(), block.size() * sizeof(CheckpointRecord));
+            out.sync();
+        }
+        std::filesystem::rename(temporary, checkpoint_path());
+        detail::posix_file::sync_directory(directory_);
+
+        for (uint64_t old : log_generations())
+        {
+            if (old < generation)
+            {
+                std::filesystem::remove(log_path(old));
+            }
+        }
+    }
+};
@@ -0,0 +1,377 @@
+#pragma once
+
+#include "unordered_dense_map.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Open-addressing map that keeps each key and value inside its bucket slot,
+// next to the probe metadata, instead of in a separate dense entry array. A
+// hit is resolved from the home slot's cache line with no second dependent
+// load; the price is that iteration walks the whole slot array, empty slots
+// included. Robin-hood probing with backward-shift deletion, so there are no
+// tombstones and every probe run stays as short as at insertion time.
+//
+// Key and Value must be default constructible. Pointers and iterators are
+// invalidated by any insert or erase.
+template <typename Key, typename Value, typename Hash = detail::hash_traits<Key>>
+class flat_dense_map
+{
+private:
+    static constexpr size_t INITIAL_CAPACITY = 16;
+    static constexpr float MAX_LOAD_FACTOR = 0.75f;
+    static constexpr size_t MAX_DISTANCE = 255;
+    static constexpr size_t LOOKUP_BLOCK = 16;
+
+    struct Entry
+    {
+        Key key;
+        Value value;
+    };
+
+    struct Slot
+    {
+        Entry entry{};
+        uint8_t distance = 0; // Probe length + 1; 0 marks an empty slot
+    };
+
+    std::vector<Slot> slots_;
+    size_t size_;
+    size_t capacity_;
+
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = Entry;
+    using size_type = size_t;
+
+    flat_dense_map() : slots_(INITIAL_CAPACITY), size_(0), capacity_(INITIAL_CAPACITY) {}
+    flat_dense_map(const flat_dense_map &other) = default;
+    flat_dense_map(flat_dense_map &&other) = default;
+    flat_dense_map &operator=(const flat_dense_map &other) = default;
+    flat_dense_map &operator=(flat_dense_map &&other) = default;
+
+    bool empty() const { return size_ == 0; }
+    size_type size() const { return size_; }
+    size_type max_size() const { return std::numeric_limits<size_type>::max(); }
+    size_type bucket_count() const { return capacity_; }
+
+    // Walks the slot array and stops at occupied slots only
+    template <bool IsConst>
+    class basic_iterator
+    {
+    public:
+        using map_pointer = std::conditional_t<IsConst, const flat_dense_map *, flat_dense_map *>;
+        using entry_type = std::conditional_t<IsConst, const Entry, Entry>;
+
+        map_pointer map_;
+        size_t index_;
+
+        basic_iterator(map_pointer map, size_t index) : map_(map), index_(index) { skip_empty(); }
+
+        // const_iterator from iterator
+        template <bool OtherConst>
+            requires(IsConst && !OtherConst)
+        basic_iterator(const basic_iterator<OtherConst> &other) : map_(other.map_), index_(other.index_) {}
+
+        entry_type &operator*() const { return map_->slots_[index_].entry; }
+        entry_type *operator->() const { return &map_->slots_[index_].entry; }
+
+        basic_iterator &operator++()
+        {
+            ++index_;
+            skip_empty();
+            return *this;
+        }
+        basic_iterator operator++(int)
+        {
+            basic_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+        bool operator==(const basic_iterator &other) const { return map_ == other.map_ && index_ == other.index_; }
+        bool operator!=(const basic_iterator &other) const { return !(*this == other); }
+
+    private:
+        void skip_empty()
+        {
+            while (index_ < map_->capacity_ && map_->slots_[index_].distance == 0)
+            {
+                ++index_;
+            }
+        }
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, capacity_); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, capacity_); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    Value &operator[](const Key &key)
+    {
+        auto [it, inserted] = try_emplace(key);
+        return it->value;
+    }
+
+    Value &at(const Key &key)
+    {
+        auto it = find(key);
+        if (it == end())
+            throw std::out_of_range("Key not found");
+        return it->value;
+    }
+
+    const Value &at(const Key &key) const
+    {
+        auto it = find(key);
+        if (it == end())
+            throw std::out_of_range("Key not found");
+        return it->value;
+    }
+
+    std::pair<iterator, bool> insert(const value_type &value) { return try_emplace(value.key, value.value); }
+    std::pair<iterator, bool> insert(const std::pair<Key, Value> &p) { return try_emplace(p.first, p.second); }
+    std::pair<iterator, bool> insert(const Key &key, const Value &value) { return try_emplace(key, value); }
+    std::pair<iterator, bool> emplace(const Key &key, const Value &value) { return try_emplace(key, value); }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args)
+    {
+        return try_emplace_hashed(key, Hash::hash(key), std::forward<Args>(args)...);
+    }
+
+    // Same as try_emplace for callers that already hold Hash::hash(key).
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace_hashed(const Key &key, uint64_t hash, Args &&...args)
+    {
+        size_t found = find_slot(key, hash);
+        if (found != npos)
+        {
+            return {iterator(this, found), false};
+        }
+
+        if (size_ + 1 > capacity_ * MAX_LOAD_FACTOR)
+        {
+            rehash(capacity_ * 2);
+        }
+        size_t landed = insert_absent(Entry{key, Value(std::forward<Args>(args)...)}, hash);
+        if (landed == npos)
+        {
+            landed = find_slot(key, hash);
+        }
+        return {iterator(this, landed), true};
+    }
+
+    // Backward-shift deletion: the run after the erased slot moves one slot
+    // closer to home until it reaches an empty slot or an entry already home.
+    size_type erase(const Key &key)
+    {
+        size_t pos = find_slot(key, Hash::hash(key));
+        if (pos == npos)
+        {
+            return 0;
+        }
+
+        const size_t mask = capacity_ - 1;
+        size_t next = (pos + 1) & mask;
+        while (slots_[next].distance > 1)
+        {
+            slots_[pos].entry = std::move(slots_[next].entry);
+            slots_[pos].distance = slots_[next].distance - 1;
+            pos = next;
+            next = (next + 1) & mask;
+        }
+        slots_[pos] = Slot{};
+        --size_;
+        return 1;
+    }
+
+    void clear()
+    {
+        std::fill(slots_.begin(), slots_.end(), Slot{});
+        size_ = 0;
+    }
+
+    // Grows the slot array so that count elements fit without a rehash.
+    void reserve(size_type count)
+    {
+        size_t needed = capacity_for(count);
+        if (needed > capacity_)
+        {
+            rehash(needed);
+        }
+    }
+
+    iterator find(const Key &key)
+    {
+        size_t pos = find_slot(key, Hash::hash(key));
+        return pos == npos ? end() : iterator(this, pos);
+    }
+    const_iterator find(const Key &key) const
+    {
+        size_t pos = find_slot(key, Hash::hash(key));
+        return pos == npos ? end() : const_iterator(this, pos);
+    }
+    size_type count(const Key &key) const { return contains(key) ? 1 : 0; }
+    bool contains(const Key &key) const { return find_slot(key, Hash::hash(key)) != npos; }
+
+    // Looks up a range of keys in blocks: every key of a block is hashed and
+    // its home slot prefetched before any of them is probed. f(position,
+    // const value_type *) is called in input order, with nullptr for absent
+    // keys.
+    template <typename ForwardIt, typename F>
+    void batch_lookup(ForwardIt first, ForwardIt last, F f) const
+    {
+        uint64_t hashes[LOOKUP_BLOCK];
+        size_t position = 0;
+        while (first != last)
+        {
+            ForwardIt block = first;
+            size_t n = 0;
+            for (; n < LOOKUP_BLOCK && first != last; ++n, ++first)
+            {
+                hashes[n] = Hash::hash(*first);
+                detail::prefetch(&slots_[detail::probe_hash(hashes[n]) & (capacity_ - 1)]);
+            }
+            for (size_t j = 0; j < n; ++j, ++block)
+            {
+                size_t pos = find_slot(*block, hashes[j]);
+                f(position++, pos == npos ? nullptr : &slots_[pos].entry);
+            }
+        }
+    }
+
+    template <typename InputIt>
+    std::vector<bool> batch_contains(InputIt first, InputIt last) const
+    {
+        std::vector<bool> results;
+        batch_lookup(first, last, [&](size_t, const Entry *entry)
+                     { results.push_back(entry != nullptr); });
+        return results;
+    }
+
+private:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    size_t capacity_for(size_t count) const
+    {
+        size_t capacity = INITIAL_CAPACITY;
+        while (count > capacity * MAX_LOAD_FACTOR)
+        {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    // A run of entries is ordered by distance, so the probe can stop at the
+    // first slot whose occupant is closer to home than the key would be.
+    size_t find_slot(const Key &key, uint64_t hash) const
+    {
+        const size_t mask = capacity_ - 1;
+        size_t pos = detail::probe_hash(hash) & mask;
+        for (size_t distance = 1; distance <= MAX_DISTANCE; ++distance)
+        {
+            const Slot &slot = slots_[pos];
+            if (slot.distance < distance)
+            {
+                return npos;
+            }
+            if (slot.entry.key == key)
+            {
+                return pos;
+            }
+            pos = (pos + 1) & mask;
+        }
+        return npos;
+    }
+
+    // Robin-hood insertion of a key that is not in the map. Returns the slot
+    // it landed in, or npos if a probe run overflowed and the table had to
+    // grow on the way, in which case the caller has to look it up again.
+    size_t insert_absent(Entry &&entry, uint64_t hash)
+    {
+        const size_t mask = capacity_ - 1;
+        size_t pos = detail::probe_hash(hash) & mask;
+        size_t landed = npos;
+        uint8_t distance = 1;
+        while (true)
+        {
+            Slot &slot = slots_[pos];
+            if (slot.distance == 0)
+            {
+                slot.entry = std::move(entry);
+                slot.distance = distance;
+                ++size_;
+                return landed == npos ? pos : landed;
+            }
+            if (slot.distance < distance)
+            {
+                std::swap(slot.entry, entry);
+                std::swap(slot.distance, distance);
+                if (landed == npos)
+                {
+                    landed = pos;
+                }
+            }
+
+            pos = (pos + 1) & mask;
+            if (distance == MAX_DISTANCE)
+            {
+                // The entry in hand may be a displaced one, so rehash it
+                uint64_t pending_hash = Hash::hash(entry.key);
+                rehash(capacity_ * 2);
+                insert_absent(std::move(entry), pending_hash);
+                return npos;
+            }
+            ++distance;
+        }
+    }
+
+    void rehash(size_t new_capacity)
+    {
+        std::vector<Slot> old(new_capacity);
+        old.swap(slots_);
+        capacity_ = new_capacity;
+        size_ = 0;
+        for (Slot &slot : old)
+        {
+            if (slot.distance != 0)
+            {
+                uint64_t hash = Hash::hash(slot.entry.key);
+                insert_absent(std::move(slot.entry), hash);
+            }
+        }
+    }
+};
+
+namespace detail
+{
+    // Small trivially copyable pairs fit a bucket slot without making the
+    // probe run span many cache lines.
+    template <typename Key, typename Value>
+    inline constexpr bool prefers_flat_storage_v =
+        std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value> &&
+        std::is_default_constructible_v<Key> && std::is_default_constructible_v<Value> &&
+        sizeof(Key) + sizeof(Value) <= 16;
+}
+
+// Picks flat_dense_map for small trivially copyable key/value pairs and
+// unordered_dense_map otherwise. Both expose the same core interface
+// (insert, try_emplace, find, erase, operator[], batch_lookup, iteration
+// over entries with .key / .value); name either class directly to opt in or
+// out.
+template <typename Key, typename Value, typename Hash = detail::hash_traits<Key>>
+using dense_map = std::conditional_t<detail::prefers_flat_storage_v<Key, Value>,
+                                     flat_dense_map<Key, Value, Hash>,
+                                     unordered_dense_map<Key, Value, Hash>>;
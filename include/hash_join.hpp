@@ -0,0 +1,161 @@
+#pragma once
+
+#include "unordered_dense_map.hpp"
+#include <cstddef>
+#include <numeric>
+#include <span>
+#include <vector>
+
+enum class join_type
+{
+    inner, // every (probe_row, build_row) pair with equal keys
+    semi,  // probe rows with at least one match
+    anti   // probe rows without a match
+};
+
+// Output buffers of hash_join::probe. build_rows is only filled by inner
+// joins; for semi and anti joins it stays empty.
+struct join_matches
+{
+    std::vector<size_t> probe_rows;
+    std::vector<size_t> build_rows;
+
+    size_t size() const { return probe_rows.size(); }
+    void clear()
+    {
+        probe_rows.clear();
+        build_rows.clear();
+    }
+};
+
+// In-memory equi-join: the build column goes into an unordered_dense_map of
+// distinct keys, each pointing at a chain of the build rows that carry it, and
+// probe columns are looked up through the map's prefetching batch pipeline.
+// Rows are identified by their position in the input columns, and an inner
+// join reports the build rows of one key in ascending order.
+template <typename Key, typename Hash = detail::hash_traits<Key>>
+class hash_join
+{
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    static constexpr size_t PROBE_CHUNK = 16384;
+
+    struct Chain
+    {
+        size_t head = npos;
+        size_t tail = npos;
+    };
+
+    unordered_dense_map<Key, Chain, Hash> table_;
+    std::vector<size_t> next_; // next_[row]: the following build row with the same key
+
+public:
+    hash_join() = default;
+    explicit hash_join(std::span<const Key> build_keys) { build(build_keys); }
+
+    // Replaces the build side with the given column.
+    void build(std::span<const Key> build_keys)
+    {
+        table_.clear();
+        next_.assign(build_keys.size(), npos);
+
+        std::vector<size_t> rows(build_keys.size());
+        std::iota(rows.begin(), rows.end(), size_t(0));
+        table_.aggregate(build_keys, rows, ChainAppend{next_.data()});
+    }
+
+    size_t build_rows() const { return next_.size(); }
+    size_t distinct_keys() const { return table_.size(); }
+
+    // Appends the matches of probe_keys to out and returns how many were added.
+    size_t probe(join_type type, std::span<const Key> probe_keys, join_matches &out) const
+    {
+        return probe(dense_execution::seq, type, probe_keys, out);
+    }
+
+    // Same, with the probe column split into chunks that run under policy.
+    // Output order is identical to the sequential probe.
+    template <detail::execution_policy Policy>
+    size_t probe(const Policy &policy, join_type type, std::span<const Key> probe_keys, join_matches &out) const
+    {
+        const size_t chunks = (probe_keys.size() + PROBE_CHUNK - 1) / PROBE_CHUNK;
+        if (chunks <= 1 || detail::policy_thread_count(policy) <= 1)
+        {
+            return probe_range(type, probe_keys, 0, out);
+        }
+
+        std::vector<join_matches> partial(chunks);
+        detail::parallel_for(chunks, detail::policy_thread_count(policy), [&](size_t c)
+                             {
+            size_t begin = c * PROBE_CHUNK;
+            size_t end = std::min(begin + PROBE_CHUNK, probe_keys.size());
+            probe_range(type, probe_keys.subspan(begin, end - begin), begin, partial[c]); });
+
+        size_t added = 0;
+        for (const auto &part : partial)
+        {
+            added += part.size();
+        }
+        out.probe_rows.reserve(out.probe_rows.size() + added);
+        if (type == join_type::inner)
+        {
+            out.build_rows.reserve(out.build_rows.size() + added);
+        }
+        for (const auto &part : partial)
+        {
+            out.probe_rows.insert(out.probe_rows.end(), part.probe_rows.begin(), part.probe_rows.end());
+            out.build_rows.insert(out.build_rows.end(), part.build_rows.begin(), part.build_rows.end());
+        }
+        return added;
+    }
+
+private:
+    // aggregate() operator that threads each build row onto its key's chain
+    struct ChainAppend
+    {
+        size_t *next;
+
+        Chain init(size_t row) const { return Chain{row, row}; }
+        void operator()(Chain &chain, size_t row) const
+        {
+            next[chain.tail] = row;
+            chain.tail = row;
+        }
+    };
+
+    size_t probe_range(join_type type, std::span<const Key> keys, size_t row_offset, join_matches &out) const
+    {
+        const size_t before = out.size();
+
+        table_.batch_lookup(keys.begin(), keys.end(), [&](size_t i, const auto *entry)
+                            {
+            const size_t probe_row = row_offset + i;
+            switch (type)
+            {
+            case join_type::inner:
+                if (entry)
+                {
+                    for (size_t row = entry->value.head; row != npos; row = next_[row])
+                    {
+                        out.probe_rows.push_back(probe_row);
+                        out.build_rows.push_back(row);
+                    }
+                }
+                break;
+            case join_type::semi:
+                if (entry)
+                {
+                    out.probe_rows.push_back(probe_row);
+                }
+                break;
+            case join_type::anti:
+                if (!entry)
+                {
+                    out.probe_rows.push_back(probe_row);
+                }
+                break;
+            } });
+
+        return out.size() - before;
+    }
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "work_stealing_executor.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace detail
+{
+    // 0 means "use every hardware thread".
+    inline size_t resolve_thread_count(size_t threads)
+    {
+        if (threads == 0)
+        {
+            threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        return threads;
+    }
+
+    // Runs f(task) for every task in [0, tasks) on up to `threads` threads of
+    // the default executor. The calling thread takes part; the first exception
+    // thrown by a task is rethrown here once every task has stopped.
+    template <typename F>
+    void parallel_for(size_t tasks, size_t threads, F &&f)
+    {
+        threads = std::min(resolve_thread_count(threads), tasks);
+        if (threads <= 1)
+        {
+            for (size_t task = 0; task < tasks; ++task)
+            {
+                f(task);
+            }
+            return;
+        }
+
+        dense_execution::default_executor().bulk(tasks, threads, [&f](size_t task)
+                                                 { f(task); });
+    }
+}
+
+// Execution policy tags for the maps' parallel algorithms. <execution> is not
+// used because libstdc++ turns it into a link dependency on TBB.
+namespace dense_execution
+{
+    struct sequenced_policy
+    {
+    };
+
+    // threads == 0 uses every hardware thread.
+    struct parallel_policy
+    {
+        size_t threads = 0;
+    };
+
+    inline constexpr sequenced_policy seq{};
+    inline constexpr parallel_policy par{};
+}
+
+namespace detail
+{
+    template <typename Policy>
+    concept execution_policy = std::is_same_v<std::remove_cvref_t<Policy>, dense_execution::sequenced_policy> ||
+                               std::is_same_v<std::remove_cvref_t<Policy>, dense_execution::parallel_policy>;
+
+    template <typename Policy>
+    size_t policy_thread_count(const Policy &policy)
+    {
+        if constexpr (std::is_same_v<Policy, dense_execution::parallel_policy>)
+        {
+            return resolve_thread_count(policy.threads);
+        }
+        else
+        {
+            return 1;
+        }
+    }
+}
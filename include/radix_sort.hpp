@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace detail
+{
+    // Keys whose order matches the unsigned order of a fixed-width bit image
+    template <typename T>
+    concept radix_sortable = std::is_integral_v<T> || std::is_enum_v<T> ||
+                             (std::is_floating_point_v<T> && std::numeric_limits<T>::is_iec559 &&
+                              (sizeof(T) == 4 || sizeof(T) == 8));
+
+    template <size_t Bytes>
+    struct unsigned_of_size;
+    template <>
+    struct unsigned_of_size<1> { using type = uint8_t; };
+    template <>
+    struct unsigned_of_size<2> { using type = uint16_t; };
+    template <>
+    struct unsigned_of_size<4> { using type = uint32_t; };
+    template <>
+    struct unsigned_of_size<8> { using type = uint64_t; };
+
+    // Maps a key to an unsigned integer with the same ordering: signed values
+    // get their sign bit flipped, negative floats are inverted entirely.
+    template <radix_sortable T>
+    auto radix_key(T value)
+    {
+        using U = typename unsigned_of_size<sizeof(T)>::type;
+        constexpr U SIGN = U(1) << (sizeof(T) * 8 - 1);
+
+        if constexpr (std::is_enum_v<T>)
+        {
+            return radix_key(static_cast<std::underlying_type_t<T>>(value));
+        }
+        else if constexpr (std::is_floating_point_v<T>)
+        {
+            U bits;
+            std::memcpy(&bits, &value, sizeof(T));
+            return (bits & SIGN) ? static_cast<U>(~bits) : static_cast<U>(bits | SIGN);
+        }
+        else if constexpr (std::is_signed_v<T>)
+        {
+            return static_cast<U>(static_cast<U>(value) ^ SIGN);
+        }
+        else
+        {
+            return static_cast<U>(value);
+        }
+    }
+
+    // Indices 0..n-1 ordered by radix_key(key_at(i)): LSD radix sort over
+    // 8-bit digits of (key, index) pairs. All digit histograms are built in
+    // one read of the input, and a pass whose digit is the same for every
+    // element is skipped, so e.g. small non-negative ints cost one or two
+    // passes rather than four.
+    template <typename T, typename KeyAt>
+    std::vector<size_t> radix_sorted_order(size_t n, KeyAt &&key_at)
+    {
+        using U = decltype(radix_key(std::declval<T>()));
+        constexpr size_t DIGITS = sizeof(U);
+
+        struct Item
+        {
+            U key;
+            size_t index;
+        };
+
+        std::vector<Item> items(n);
+        std::vector<size_t> histogram(DIGITS * 256, 0);
+        for (size_t i = 0; i < n; ++i)
+        {
+            U key = radix_key(static_cast<T>(key_at(i)));
+            items[i] = {key, i};
+            for (size_t d = 0; d < DIGITS; ++d)
+            {
+                ++histogram[d * 256 + ((key >> (d * 8)) & 0xFF)];
+            }
+        }
+
+        std::vector<Item> scratch(n);
+        for (size_t d = 0; d < DIGITS; ++d)
+        {
+            size_t *counts = &histogram[d * 256];
+            if (n == 0 || counts[(items[0].key >> (d * 8)) & 0xFF] == n)
+            {
+                continue; // Every element has the same digit here
+            }
+
+            size_t offset = 0;
+            for (size_t b = 0; b < 256; ++b)
+            {
+                size_t count = counts[b];
+                counts[b] = offset;
+                offset += count;
+            }
+            for (const Item &item : items)
+            {
+                scratch[counts[(item.key >> (d * 8)) & 0xFF]++] = item;
+            }
+            items.swap(scratch);
+        }
+
+        std::vector<size_t> order(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            order[i] = items[i].index;
+        }
+        return order;
+    }
+}
@@ -0,0 +1,552 @@
+#pragma once
+
+#include "unordered_dense_map.hpp"
+#include <atomic>
+#include <exception>
+#include <future>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace detail
+{
+    // Move-only stand-in for std::function (C++20 has no
+    // std::move_only_function), so callbacks may capture move-only state.
+    template <typename Signature>
+    class unique_function;
+
+    template <typename R, typename... Args>
+    class unique_function<R(Args...)>
+    {
+    public:
+        unique_function() = default;
+
+        template <typename F>
+            requires(!std::is_same_v<std::decay_t<F>, unique_function>)
+        unique_function(F &&f) : callable_(std::make_unique<Holder<std::decay_t<F>>>(std::forward<F>(f)))
+        {
+        }
+
+        explicit operator bool() const { return callable_ != nullptr; }
+
+        R operator()(Args... args) { return callable_->call(std::forward<Args>(args)...); }
+
+    private:
+        struct Callable
+        {
+            virtual ~Callable() = default;
+            virtual R call(Args... args) = 0;
+        };
+
+        template <typename F>
+        struct Holder final : Callable
+        {
+            template <typename G>
+            explicit Holder(G &&g) : f(std::forward<G>(g))
+            {
+            }
+
+            R call(Args... args) override { return f(std::forward<Args>(args)...); }
+
+            F f;
+        };
+
+        std::unique_ptr<Callable> callable_;
+    };
+
+    // Bounded multi-producer / single-consumer ring buffer (Vyukov's sequence
+    // scheme). Producers claim a slot with one CAS on the tail; the owning
+    // consumer never contends with anyone.
+    template <typename T>
+    class mpsc_ring
+    {
+    public:
+        explicit mpsc_ring(size_t capacity)
+        {
+            size_t rounded = 2;
+            while (rounded < capacity)
+            {
+                rounded *= 2;
+            }
+            mask_ = rounded - 1;
+            cells_ = std::make_unique<Cell[]>(rounded);
+            for (size_t i = 0; i < rounded; ++i)
+            {
+                cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        bool try_push(T &&item)
+        {
+            size_t pos = tail_.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell &cell = cells_[pos & mask_];
+                size_t seq = cell.sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+                if (diff == 0)
+                {
+                    if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        cell.item = std::move(item);
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false; // Full
+                }
+                else
+                {
+                    pos = tail_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool try_pop(T &out)
+        {
+            Cell &cell = cells_[head_ & mask_];
+            size_t seq = cell.sequence.load(std::memory_order_acquire);
+            if (seq != head_ + 1)
+            {
+                return false; // Empty (or a producer is mid-write)
+            }
+
+            out = std::move(cell.item);
+            cell.sequence.store(head_ + mask_ + 1, std::memory_order_release);
+            ++head_;
+            return true;
+        }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence{0};
+            T item{};
+        };
+
+        std::unique_ptr<Cell[]> cells_;
+        size_t mask_ = 0;
+        alignas(64) std::atomic<size_t> tail_{0};
+        alignas(64) size_t head_ = 0;
+    };
+}
+
+// Shared-nothing map: each shard is a plain unordered_dense_map owned by one
+// worker thread. Callers never touch shard state; operations are routed by hash
+// bits into the owner's ring buffer and results come back through futures or
+// callbacks executed on the owner thread.
+template <typename Key, typename Value, typename Hash = detail::hash_traits<Key>>
+class sharded_unordered_dense_map
+{
+private:
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 4096;
+    static constexpr size_t MAX_BATCH = 64;
+
+    using shard_map = unordered_dense_map<Key, Value, Hash>;
+
+    enum class Op : uint8_t
+    {
+        Insert,
+        Assign,
+        AssignBatch,
+        Update,
+        Erase,
+        Find,
+        Visit,
+        Flush,
+        Stop
+    };
+
+    struct Request
+    {
+        Op op = Op::Flush;
+        Key key{};
+        Value value{};
+        std::vector<std::pair<Key, Value>> batch;
+        // Fire-and-forget requests leave this empty so they never allocate
+        // a shared state.
+        std::variant<std::monostate, std::promise<bool>, std::promise<std::optional<Value>>> reply;
+        detail::unique_function<void(Value *)> callback;
+
+        std::future<bool> expect_done()
+        {
+            return reply.template emplace<std::promise<bool>>().get_future();
+        }
+
+        std::future<std::optional<Value>> expect_found()
+        {
+            return reply.template emplace<std::promise<std::optional<Value>>>().get_future();
+        }
+
+        void set_done(bool result) { std::get<std::promise<bool>>(reply).set_value(result); }
+        void set_found(std::optional<Value> result)
+        {
+            std::get<std::promise<std::optional<Value>>>(reply).set_value(std::move(result));
+        }
+
+        // Hands error to the request's future; false for fire-and-forget
+        // requests, which have none.
+        bool set_error(std::exception_ptr error)
+        {
+            return std::visit([&](auto &promise)
+                              {
+                if constexpr (std::is_same_v<std::decay_t<decltype(promise)>, std::monostate>)
+                {
+                    return false;
+                }
+                else
+                {
+                    promise.set_exception(error);
+                    return true;
+                } },
+                              reply);
+        }
+    };
+
+    struct Shard
+    {
+        explicit Shard(size_t queue_capacity) : queue(queue_capacity) {}
+
+        shard_map map;
+        detail::mpsc_ring<Request> queue;
+        std::atomic<uint64_t> pushed{0};
+        std::atomic<bool> sleeping{false};
+        std::atomic<size_t> size{0};
+        // First exception thrown by a fire-and-forget request since the last
+        // flush; owner-thread only.
+        std::exception_ptr error;
+        std::thread worker;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using size_type = size_t;
+
+    explicit sharded_unordered_dense_map(size_t shard_count = std::thread::hardware_concurrency(),
+                                         size_t queue_capacity = DEFAULT_QUEUE_CAPACITY)
+    {
+        if (shard_count == 0)
+        {
+            shard_count = 1;
+        }
+
+        shards_.reserve(shard_count);
+        for (size_t i = 0; i < shard_count; ++i)
+        {
+            shards_.push_back(std::make_unique<Shard>(queue_capacity));
+        }
+        for (auto &shard : shards_)
+        {
+            Shard *s = shard.get();
+            s->worker = std::thread([this, s]()
+                                    { run_shard(*s); });
+        }
+    }
+
+    ~sharded_unordered_dense_map()
+    {
+        for (auto &shard : shards_)
+        {
+            Request req;
+            req.op = Op::Stop;
+            enqueue(*shard, std::move(req));
+        }
+        for (auto &shard : shards_)
+        {
+            shard->worker.join();
+        }
+    }
+
+    sharded_unordered_dense_map(const sharded_unordered_dense_map &) = delete;
+    sharded_unordered_dense_map &operator=(const sharded_unordered_dense_map &) = delete;
+
+    size_t shard_count() const { return shards_.size(); }
+
+    size_t shard_of(const Key &key) const
+    {
+        // Use the high hash bits so shard routing stays independent of the
+        // low bits each shard uses for its bucket position.
+        uint64_t high = Hash::hash(key) >> 32;
+        return static_cast<size_t>((high * shards_.size()) >> 32);
+    }
+
+    // Inserts if absent; the future reports whether the key was new.
+    std::future<bool> insert(const Key &key, const Value &value)
+    {
+        Request req;
+        req.op = Op::Insert;
+        req.key = key;
+        req.value = value;
+        auto result = req.expect_done();
+        enqueue(*shards_[shard_of(key)], std::move(req));
+        return result;
+    }
+
+    // Fire-and-forget insert-or-overwrite.
+    void assign(const Key &key, const Value &value)
+    {
+        Request req;
+        req.op = Op::Assign;
+        req.key = key;
+        req.value = value;
+        enqueue(*shards_[shard_of(key)], std::move(req));
+    }
+
+    // Groups the range by shard first so each owner receives one request per
+    // batch instead of one per element.
+    template <typename InputIt>
+    void batch_assign(InputIt first, InputIt last)
+    {
+        std::vector<std::vector<std::pair<Key, Value>>> per_shard(shards_.size());
+        for (auto it = first; it != last; ++it)
+        {
+            per_shard[shard_of(it->first)].emplace_back(it->first, it->second);
+        }
+
+        for (size_t i = 0; i < shards_.size(); ++i)
+        {
+            if (per_shard[i].empty())
+            {
+                continue;
+            }
+            Request req;
+            req.op = Op::AssignBatch;
+            req.batch = std::move(per_shard[i]);
+            enqueue(*shards_[i], std::move(req));
+        }
+    }
+
+    // Runs f(Value &) on the owner thread, default-constructing the value if
+    // the key is absent. Fire-and-forget; use flush() to observe the effect,
+    // including any exception f throws. f may be move-only.
+    template <typename F>
+    void update(const Key &key, F &&f)
+    {
+        Request req;
+        req.op = Op::Update;
+        req.key = key;
+        req.callback = [fn = std::forward<F>(f)](Value *value) mutable
+        { fn(*value); };
+        enqueue(*shards_[shard_of(key)], std::move(req));
+    }
+
+    std::future<bool> erase(const Key &key)
+    {
+        Request req;
+        req.op = Op::Erase;
+        req.key = key;
+        auto result = req.expect_done();
+        enqueue(*shards_[shard_of(key)], std::move(req));
+        return result;
+    }
+
+    std::future<std::optional<Value>> find(const Key &key)
+    {
+        Request req;
+        req.op = Op::Find;
+        req.key = key;
+        auto result = req.expect_found();
+        enqueue(*shards_[shard_of(key)], std::move(req));
+        return result;
+    }
+
+    // Callback flavour of find: f(const Value *) runs on the owner thread and
+    // receives nullptr when the key is absent. Exceptions from f surface from
+    // the next flush().
+    template <typename F>
+    void find(const Key &key, F &&f)
+    {
+        Request req;
+        req.op = Op::Visit;
+        req.key = key;
+        req.callback = [fn = std::forward<F>(f)](Value *value) mutable
+        { fn(static_cast<const Value *>(value)); };
+        enqueue(*shards_[shard_of(key)], std::move(req));
+    }
+
+    // Blocks until every operation submitted before the call has been applied,
+    // then rethrows the first exception a fire-and-forget request (assign,
+    // batch_assign, update, callback find) threw since the previous flush.
+    void flush()
+    {
+        std::vector<std::future<bool>> pending;
+        pending.reserve(shards_.size());
+        for (auto &shard : shards_)
+        {
+            Request req;
+            req.op = Op::Flush;
+            pending.push_back(req.expect_done());
+            enqueue(*shard, std::move(req));
+        }
+        std::exception_ptr first;
+        for (auto &f : pending)
+        {
+            try
+            {
+                f.get();
+            }
+            catch (...)
+            {
+                if (!first)
+                {
+                    first = std::current_exception();
+                }
+            }
+        }
+        if (first)
+        {
+            std::rethrow_exception(first);
+        }
+    }
+
+    // Sum of the sizes last published by each owner thread.
+    size_type size() const
+    {
+        size_type total = 0;
+        for (const auto &shard : shards_)
+        {
+            total += shard->size.load(std::memory_order_acquire);
+        }
+        return total;
+    }
+
+    bool empty() const { return size() == 0; }
+
+private:
+    void enqueue(Shard &shard, Request &&req)
+    {
+        while (!shard.queue.try_push(std::move(req)))
+        {
+            std::this_thread::yield();
+        }
+
+        shard.pushed.fetch_add(1);
+        if (shard.sleeping.load())
+        {
+            shard.pushed.notify_one();
+        }
+    }
+
+    void run_shard(Shard &shard)
+    {
+        std::vector<Request> batch(MAX_BATCH);
+
+        while (true)
+        {
+            uint64_t seen = shard.pushed.load();
+
+            size_t count = 0;
+            while (count < MAX_BATCH && shard.queue.try_pop(batch[count]))
+            {
+                ++count;
+            }
+
+            if (count == 0)
+            {
+                shard.sleeping.store(true);
+                if (shard.pushed.load() == seen)
+                {
+                    shard.pushed.wait(seen);
+                }
+                shard.sleeping.store(false);
+                continue;
+            }
+
+            bool stop = false;
+            for (size_t i = 0; i < count; ++i)
+            {
+                // A throwing request must not take the owner thread down;
+                // its error goes back to whoever is waiting on it.
+                try
+                {
+                    stop |= apply(shard, batch[i]);
+                }
+                catch (...)
+                {
+                    if (!batch[i].set_error(std::current_exception()) && !shard.error)
+                    {
+                        shard.error = std::current_exception();
+                    }
+                }
+                batch[i] = Request{};
+            }
+            shard.size.store(shard.map.size(), std::memory_order_release);
+
+            if (stop)
+            {
+                return;
+            }
+        }
+    }
+
+    // Returns true when the owner should exit.
+    bool apply(Shard &shard, Request &req)
+    {
+        shard_map &map = shard.map;
+
+        switch (req.op)
+        {
+        case Op::Insert:
+            req.set_done(map.try_emplace(req.key, std::move(req.value)).second);
+            break;
+        case Op::Assign:
+            map[req.key] = std::move(req.value);
+            break;
+        case Op::AssignBatch:
+            for (auto &kv : req.batch)
+            {
+                map[kv.first] = std::move(kv.second);
+            }
+            break;
+        case Op::Update:
+            req.callback(&map[req.key]);
+            break;
+        case Op::Erase:
+            req.set_done(map.erase(req.key) == 1);
+            break;
+        case Op::Find:
+        {
+            auto it = map.find(req.key);
+            if (it != map.end())
+            {
+                req.set_found(it->value);
+            }
+            else
+            {
+                req.set_found(std::nullopt);
+            }
+            break;
+        }
+        case Op::Visit:
+        {
+            auto it = map.find(req.key);
+            req.callback(it != map.end() ? &it->value : nullptr);
+            break;
+        }
+        case Op::Flush:
+            shard.size.store(map.size(), std::memory_order_release);
+            if (shard.error)
+            {
+                req.set_error(std::exchange(shard.error, nullptr));
+            }
+            else
+            {
+                req.set_done(true);
+            }
+            break;
+        case Op::Stop:
+            return true;
+        }
+        return false;
+    }
+};
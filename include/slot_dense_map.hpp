@@ -0,0 +1,224 @@
+#pragma once
+
+#include "unordered_dense_map.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// unordered_dense_map whose entries can also be reached through stable
+// handles, slot-map style. A handle names a slot, and the slot holds the
+// entry's current index in the dense array together with a generation. When
+// erase moves the last entry into a hole, only that entry's slot is
+// repointed, so every other handle stays valid across erasures and rehashes.
+// Erasing an entry bumps its slot's generation, so old handles to it resolve
+// to nullptr rather than to whichever entry reuses the slot.
+//
+// get(handle) is two array reads and no hashing or probing. Each entry
+// carries its 32-bit slot number beside the value, and there are at most
+// 2^32 - 1 slots.
+template <typename Key, typename Value, typename Hash = detail::hash_traits<Key>>
+class slot_dense_map
+{
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using size_type = size_t;
+
+    struct handle
+    {
+        uint32_t slot = NONE;
+        uint32_t generation = 0;
+
+        bool operator==(const handle &) const = default;
+    };
+
+private:
+    static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+    struct Slotted
+    {
+        template <typename... Args>
+        explicit Slotted(std::in_place_t, Args &&...args) : value(std::forward<Args>(args)...)
+        {
+        }
+
+        Value value;
+        uint32_t slot = NONE;
+    };
+
+    using map_type = unordered_dense_map<Key, Slotted, Hash>;
+
+    // A live slot's index is its entry's position in the dense array; a free
+    // slot's index links the free list.
+    struct Slot
+    {
+        uint32_t index;
+        uint32_t generation;
+    };
+
+    map_type map_;
+    std::vector<Slot> slots_;
+    uint32_t free_head_ = NONE;
+
+public:
+    bool empty() const { return map_.empty(); }
+    size_type size() const { return map_.size(); }
+    void reserve(size_type count)
+    {
+        map_.reserve(count);
+        slots_.reserve(count);
+    }
+
+    // Handle to key's entry, inserting Value(args...) if the key is absent.
+    template <typename... Args>
+    std::pair<handle, bool> try_emplace(const Key &key, Args &&...args)
+    {
+        return try_emplace_hashed(key, Hash::hash(key), std::forward<Args>(args)...);
+    }
+
+    template <typename... Args>
+    std::pair<handle, bool> try_emplace_hashed(const Key &key, uint64_t hash, Args &&...args)
+    {
+        auto [it, inserted] = map_.try_emplace_hashed(key, hash, std::in_place, std::forward<Args>(args)...);
+        if (!inserted)
+        {
+            return {handle_of_slot(it->value.slot), false};
+        }
+        // The slot is taken once the entry exists, so a throwing Value
+        // constructor cannot leak one
+        uint32_t slot;
+        try
+        {
+            slot = allocate_slot();
+        }
+        catch (...)
+        {
+            map_.erase_at(it.index());
+            throw;
+        }
+        it->value.slot = slot;
+        slots_[slot].index = static_cast<uint32_t>(it.index());
+        return {handle_of_slot(slot), true};
+    }
+
+    std::pair<handle, bool> insert(const Key &key, const Value &value) { return try_emplace(key, value); }
+
+    // Handle to key's entry, or a default handle when the key is absent.
+    handle find(const Key &key) const
+    {
+        auto it = map_.find(key);
+        return it == map_.end() ? handle{} : handle_of_slot(it->value.slot);
+    }
+
+    bool contains(const Key &key) const { return map_.contains(key); }
+    bool contains(handle h) const { return live(h); }
+
+    // Value behind h, or nullptr once its entry has been erased.
+    Value *get(handle h) { return live(h) ? &map_.entry_at(slots_[h.slot].index).value.value : nullptr; }
+    const Value *get(handle h) const { return live(h) ? &map_.entry_at(slots_[h.slot].index).value.value : nullptr; }
+    const Key *key_of(handle h) const { return live(h) ? &map_.entry_at(slots_[h.slot].index).key : nullptr; }
+
+    Value &at(handle h)
+    {
+        Value *value = get(h);
+        if (!value)
+            throw std::out_of_range("Stale handle");
+        return *value;
+    }
+    Value &at(const Key &key)
+    {
+        auto it = map_.find(key);
+        if (it == map_.end())
+            throw std::out_of_range("Key not found");
+        return it->value.value;
+    }
+
+    size_type erase(const Key &key)
+    {
+        const uint64_t hash = Hash::hash(key);
+        auto it = map_.find_hashed(key, hash);
+        if (it == map_.end())
+        {
+            return 0;
+        }
+        const uint32_t slot = it->value.slot;
+        const size_t index = it.index();
+        map_.erase_at(index);
+        after_erase(slot, index);
+        return 1;
+    }
+
+    // Erases h's entry; false if it was already gone.
+    bool erase(handle h)
+    {
+        if (!live(h))
+        {
+            return false;
+        }
+        const size_t index = slots_[h.slot].index;
+        map_.erase_at(index);
+        after_erase(h.slot, index);
+        return true;
+    }
+
+    void clear()
+    {
+        for (auto &e : map_)
+        {
+            release_slot(e.value.slot);
+        }
+        map_.clear();
+    }
+
+    // f(handle, const Key &, Value &) for every entry, in dense order.
+    template <typename F>
+    void for_each(F f)
+    {
+        for (auto &e : map_)
+        {
+            f(handle_of_slot(e.value.slot), e.key, e.value.value);
+        }
+    }
+
+private:
+    handle handle_of_slot(uint32_t slot) const { return {slot, slots_[slot].generation}; }
+
+    bool live(handle h) const { return h.slot < slots_.size() && slots_[h.slot].generation == h.generation; }
+
+    uint32_t allocate_slot()
+    {
+        if (free_head_ != NONE)
+        {
+            const uint32_t slot = free_head_;
+            free_head_ = slots_[slot].index;
+            return slot;
+        }
+        if (slots_.size() == NONE)
+        {
+            throw std::length_error("slot_dense_map: out of slots");
+        }
+        slots_.push_back({0, 0});
+        return static_cast<uint32_t>(slots_.size() - 1);
+    }
+
+    // The generation bump is what invalidates outstanding handles.
+    void release_slot(uint32_t slot)
+    {
+        ++slots_[slot].generation;
+        slots_[slot].index = free_head_;
+        free_head_ = slot;
+    }
+
+    // Erase moved the last entry into index, unless index was the last.
+    void after_erase(uint32_t slot, size_t index)
+    {
+        release_slot(slot);
+        if (index < map_.size())
+        {
+            slots_[map_.entry_at(index).value.slot].index = static_cast<uint32_t>(index);
+        }
+    }
+};
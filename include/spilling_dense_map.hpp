@@ -0,0 +1,257 @@
+#pragma once
+
+#include "unordered_dense_map.hpp"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
+
+namespace detail
+{
+    // Shared by every specialization, so that maps of different types can
+    // spill into the same directory without clashing file names.
+    inline uint64_t next_spill_id()
+    {
+        static std::atomic<uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+}
+
+// Hash map for inputs larger than memory, built by hash partitioning: keys
+// go to one of a fixed number of partitions by their high hash bits, and
+// each partition is an unordered_dense_map. Once the resident partitions hold
+// more than max_resident entries, the largest one is appended to its spill
+// file in one sequential write and dropped from memory. for_each_partition
+// then replays each partition's file sequentially, folds in the entries
+// still resident, and hands the finished partition to the caller, so only
+// one spilled partition is rebuilt in memory at a time.
+//
+// A key that is inserted again combines with the value it already has:
+// value = combine(older, newer), keep-first by default. Key and Value are
+// written as raw bytes and must be trivially copyable. Spill files live in
+// the given directory and are removed by the destructor.
+template <typename Key, typename Value, typename Combine = detail::keep_existing, typename Hash = detail::hash_traits<Key>>
+class spilling_dense_map
+{
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>,
+                  "spilled entries are written as raw bytes");
+
+public:
+    using map_type = unordered_dense_map<Key, Value, Hash>;
+
+private:
+    static constexpr size_t IO_BLOCK = 4096; // Records per read or write call
+
+    struct Record
+    {
+        Key key;
+        Value value;
+    };
+
+    struct Partition
+    {
+        map_type map;
+        size_t spilled = 0; // Records in the spill file
+    };
+
+    std::filesystem::path directory_;
+    std::string prefix_;
+    size_t max_resident_;
+    size_t resident_ = 0;
+    size_t spilled_ = 0;
+    Combine combine_;
+    std::vector<Partition> partitions_;
+
+    static size_t partition_of(uint64_t hash, size_t partition_count)
+    {
+        return static_cast<size_t>(((hash >> 32) * partition_count) >> 32);
+    }
+
+public:
+    // Choose partitions so that one partition's distinct keys fit in memory
+    // next to max_resident entries.
+    spilling_dense_map(std::filesystem::path directory, size_t max_resident, size_t partitions = 256,
+                       Combine combine = Combine{})
+        : directory_(std::move(directory)),
+          prefix_("spill-" + std::to_string(detail::next_spill_id()) + "-"),
+          max_resident_(max_resident),
+          combine_(std::move(combine)),
+          partitions_(std::max<size_t>(partitions, 1))
+    {
+        std::filesystem::create_directories(directory_);
+    }
+
+    spilling_dense_map(const spilling_dense_map &) = delete;
+    spilling_dense_map &operator=(const spilling_dense_map &) = delete;
+
+    ~spilling_dense_map()
+    {
+        for (size_t p = 0; p < partitions_.size(); ++p)
+        {
+            if (partitions_[p].spilled != 0)
+            {
+                std::error_code ignored;
+                std::filesystem::remove(spill_path(p), ignored);
+            }
+        }
+    }
+
+    void insert(const Key &key, const Value &value)
+    {
+        const uint64_t hash = Hash::hash(key);
+        const size_t p = partition_of(hash, partitions_.size());
+        auto [it, inserted] = partitions_[p].map.try_emplace_hashed(key, hash, value);
+        if (!inserted)
+        {
+            it->value = combine_(it->value, value);
+        }
+        else if (++resident_ > max_resident_)
+        {
+            spill_largest();
+        }
+    }
+
+    size_t partition_count() const { return partitions_.size(); }
+    size_t resident_size() const { return resident_; }
+    size_t spilled_records() const { return spilled_; }
+
+    // Calls f(p, map) for every non-empty partition in turn, where map holds
+    // partition p's final contents: its spill file replayed in write order,
+    // then the resident entries. The map passed to f may be modified; spilled
+    // partitions are rebuilt for the call only, resident ones are passed as
+    // is. Partitions hold disjoint keys.
+    template <typename F>
+    void for_each_partition(F f)
+    {
+        for (size_t p = 0; p < partitions_.size(); ++p)
+        {
+            Partition &partition = partitions_[p];
+            if (partition.spilled == 0)
+            {
+                if (!partition.map.empty())
+                {
+                    f(p, partition.map);
+                }
+                continue;
+            }
+
+            map_type merged = replay(p);
+            for (const auto &entry : partition.map)
+            {
+                auto [it, inserted] = merged.try_emplace(entry.key, entry.value);
+                if (!inserted)
+                {
+                    it->value = combine_(it->value, entry.value);
+                }
+            }
+            f(p, merged);
+        }
+    }
+
+private:
+    std::filesystem::path spill_path(size_t p) const
+    {
+        return directory_ / (prefix_ + std::to_string(p) + ".bin");
+    }
+
+    void spill_largest()
+    {
+        size_t largest = 0;
+        for (size_t p = 1; p < partitions_.size(); ++p)
+        {
+            if (partitions_[p].map.size() > partitions_[largest].map.size())
+            {
+                largest = p;
+            }
+        }
+
+        Partition &partition = partitions_[largest];
+        const std::filesystem::path path = spill_path(largest);
+        const uintmax_t committed = partition.spilled * sizeof(Record); // File size before this spill
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        try
+        {
+            std::vector<Record> block;
+            block.reserve(IO_BLOCK);
+            auto flush = [&]()
+            {
+                out.write(reinterpret_cast<const char *>(block.data()),
+                          static_cast<std::streamsize>(block.size() * sizeof(Record)));
+                block.clear();
+            };
+            for (const auto &entry : partition.map)
+            {
+                block.push_back({entry.key, entry.value});
+                if (block.size() == IO_BLOCK)
+                {
+                    flush();
+                }
+            }
+            flush();
+            out.close();
+            if (!out)
+            {
+                throw std::runtime_error("spilling_dense_map: cannot write " + path.string());
+            }
+        }
+        catch (...)
+        {
+            // Cut off a partial write, so the partition stays resident and
+            // a later spill appends right after the records already counted.
+            // A file that held nothing yet goes, as the destructor skips it.
+            out.close();
+            std::error_code ignored;
+            if (committed == 0)
+            {
+                std::filesystem::remove(path, ignored);
+            }
+            else
+            {
+                std::filesystem::resize_file(path, committed, ignored);
+            }
+            throw;
+        }
+
+        // Assigning a fresh map releases the buckets as well as the entries
+        partition.spilled += partition.map.size();
+        spilled_ += partition.map.size();
+        resident_ -= partition.map.size();
+        partition.map = map_type();
+    }
+
+    map_type replay(size_t p)
+    {
+        std::ifstream in(spill_path(p), std::ios::binary);
+        if (!in)
+        {
+            throw std::runtime_error("spilling_dense_map: cannot read " + spill_path(p).string());
+        }
+
+        map_type merged;
+        std::vector<Record> block(IO_BLOCK);
+        size_t remaining = partitions_[p].spilled;
+        while (remaining != 0)
+        {
+            const size_t n = std::min(remaining, IO_BLOCK);
+            if (!in.read(reinterpret_cast<char *>(block.data()), static_cast<std::streamsize>(n * sizeof(Record))))
+            {
+                throw std::runtime_error("spilling_dense_map: truncated " + spill_path(p).string());
+            }
+            for (size_t i = 0; i < n; ++i)
+            {
+                auto [it, inserted] = merged.try_emplace(block[i].key, block[i].value);
+                if (!inserted)
+                {
+                    it->value = combine_(it->value, block[i].value);
+                }
+            }
+            remaining -= n;
+        }
+        return merged;
+    }
+};
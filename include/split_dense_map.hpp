@@ -0,0 +1,349 @@
+#pragma once
+
+#include "unordered_dense_map.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Dense map with a structure-of-arrays entry layout: keys and values live in
+// two parallel arrays behind the same robin-hood bucket index as
+// unordered_dense_map. Probing compares fingerprints and then keys only, so
+// large values are never pulled into cache by a miss or a collision, and
+// keys() is a contiguous span. Values are touched only once a key matched.
+//
+// Iterators yield a {key, value} reference pair rather than an Entry, since
+// no Entry object exists. Erase moves the last key/value into the hole, as in
+// unordered_dense_map, and removes the bucket by backward shifting.
+template <typename Key, typename Value, typename Hash = detail::hash_traits<Key>>
+class split_dense_map
+{
+private:
+    static constexpr size_t INITIAL_CAPACITY = 16;
+    static constexpr float MAX_LOAD_FACTOR = 0.75f;
+    static constexpr size_t MAX_DISTANCE = 255;
+
+    std::vector<detail::Bucket> buckets_;
+    std::vector<Key> keys_;
+    std::vector<Value> values_;
+    size_t capacity_;
+
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using size_type = size_t;
+
+    split_dense_map() : buckets_(INITIAL_CAPACITY), capacity_(INITIAL_CAPACITY) {}
+    split_dense_map(const split_dense_map &other) = default;
+    split_dense_map(split_dense_map &&other) = default;
+    split_dense_map &operator=(const split_dense_map &other) = default;
+    split_dense_map &operator=(split_dense_map &&other) = default;
+
+    bool empty() const { return keys_.empty(); }
+    size_type size() const { return keys_.size(); }
+    size_type max_size() const { return std::numeric_limits<size_type>::max(); }
+
+    // Dense columns in iteration order; keys()[i] belongs to values()[i].
+    std::span<const Key> keys() const { return keys_; }
+    std::span<Value> values() { return values_; }
+    std::span<const Value> values() const { return values_; }
+
+    template <bool IsConst>
+    class basic_iterator
+    {
+    public:
+        using map_pointer = std::conditional_t<IsConst, const split_dense_map *, split_dense_map *>;
+        using value_reference = std::conditional_t<IsConst, const Value &, Value &>;
+
+        struct reference
+        {
+            const Key &key;
+            value_reference value;
+        };
+
+        // operator-> has to hand out something that outlives the call
+        struct pointer
+        {
+            reference ref;
+            const reference *operator->() const { return &ref; }
+        };
+
+        map_pointer map_;
+        size_t index_;
+
+        basic_iterator(map_pointer map, size_t index) : map_(map), index_(index) {}
+
+        template <bool OtherConst>
+            requires(IsConst && !OtherConst)
+        basic_iterator(const basic_iterator<OtherConst> &other) : map_(other.map_), index_(other.index_) {}
+
+        reference operator*() const { return {map_->keys_[index_], map_->values_[index_]}; }
+        pointer operator->() const { return {**this}; }
+
+        basic_iterator &operator++()
+        {
+            ++index_;
+            return *this;
+        }
+        basic_iterator operator++(int)
+        {
+            basic_iterator tmp = *this;
+            ++index_;
+            return tmp;
+        }
+        bool operator==(const basic_iterator &other) const { return map_ == other.map_ && index_ == other.index_; }
+        bool operator!=(const basic_iterator &other) const { return !(*this == other); }
+    };
+
+    using iterator = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, size()); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    Value &operator[](const Key &key)
+    {
+        auto [it, inserted] = try_emplace(key);
+        return values_[it.index_];
+    }
+
+    Value &at(const Key &key)
+    {
+        size_t index = find_index(key, Hash::hash(key));
+        if (index == npos)
+            throw std::out_of_range("Key not found");
+        return values_[index];
+    }
+
+    const Value &at(const Key &key) const
+    {
+        size_t index = find_index(key, Hash::hash(key));
+        if (index == npos)
+            throw std::out_of_range("Key not found");
+        return values_[index];
+    }
+
+    std::pair<iterator, bool> insert(const std::pair<Key, Value> &p) { return try_emplace(p.first, p.second); }
+    std::pair<iterator, bool> insert(const Key &key, const Value &value) { return try_emplace(key, value); }
+    std::pair<iterator, bool> emplace(const Key &key, const Value &value) { return try_emplace(key, value); }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args)
+    {
+        return try_emplace_hashed(key, Hash::hash(key), std::forward<Args>(args)...);
+    }
+
+    // Same as try_emplace for callers that already hold Hash::hash(key).
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace_hashed(const Key &key, uint64_t hash, Args &&...args)
+    {
+        size_t existing = find_index(key, hash);
+        if (existing != npos)
+        {
+            return {iterator(this, existing), false};
+        }
+
+        if (size() >= capacity_ * MAX_LOAD_FACTOR)
+        {
+            rehash(capacity_ * 2);
+        }
+
+        // The value goes in first, and is taken back if the key copy throws,
+        // so the columns never differ in length
+        size_t index = keys_.size();
+        values_.emplace_back(std::forward<Args>(args)...);
+        try
+        {
+            keys_.push_back(key);
+        }
+        catch (...)
+        {
+            values_.pop_back();
+            throw;
+        }
+        if (!insert_bucket(hash, index))
+        {
+            rehash(capacity_ * 2);
+        }
+        return {iterator(this, index), true};
+    }
+
+    size_type erase(const Key &key)
+    {
+        size_t pos = find_bucket(key, Hash::hash(key));
+        if (pos == npos)
+        {
+            return 0;
+        }
+        const size_t index = buckets_[pos].entry_index;
+        remove_bucket(pos);
+
+        // Fill the hole with the last key/value and repoint its bucket, which
+        // is found by probing from the moved key's home rather than scanning
+        const size_t last = keys_.size() - 1;
+        if (index != last)
+        {
+            keys_[index] = std::move(keys_[last]);
+            values_[index] = std::move(values_[last]);
+            buckets_[bucket_of_index(Hash::hash(keys_[index]), last)].entry_index = index;
+        }
+        keys_.pop_back();
+        values_.pop_back();
+        return 1;
+    }
+
+    void clear()
+    {
+        buckets_.assign(capacity_, detail::Bucket{});
+        keys_.clear();
+        values_.clear();
+    }
+
+    // Grows the bucket array so that count elements fit without a rehash.
+    void reserve(size_type count)
+    {
+        size_t new_capacity = capacity_;
+        while (count >= new_capacity * MAX_LOAD_FACTOR)
+        {
+            new_capacity *= 2;
+        }
+        if (new_capacity != capacity_)
+        {
+            rehash(new_capacity);
+        }
+        keys_.reserve(count);
+        values_.reserve(count);
+    }
+
+    iterator find(const Key &key)
+    {
+        size_t index = find_index(key, Hash::hash(key));
+        return index == npos ? end() : iterator(this, index);
+    }
+    const_iterator find(const Key &key) const
+    {
+        size_t index = find_index(key, Hash::hash(key));
+        return index == npos ? end() : const_iterator(this, index);
+    }
+    size_type count(const Key &key) const { return contains(key) ? 1 : 0; }
+    bool contains(const Key &key) const { return find_index(key, Hash::hash(key)) != npos; }
+
+private:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    // Bucket position holding key, or npos. Without tombstones a probe can
+    // stop at the first bucket that is closer to home than the key would be.
+    size_t find_bucket(const Key &key, uint64_t hash) const
+    {
+        const uint8_t fingerprint = detail::fingerprint_of(hash);
+        const size_t mask = capacity_ - 1;
+        size_t pos = detail::probe_hash(hash) & mask;
+        for (size_t distance = 0; distance < MAX_DISTANCE; ++distance)
+        {
+            const detail::Bucket &bucket = buckets_[pos];
+            if (!bucket.is_occupied() || bucket.distance < distance)
+            {
+                return npos;
+            }
+            if (bucket.fingerprint == fingerprint && keys_[bucket.entry_index] == key)
+            {
+                return pos;
+            }
+            pos = (pos + 1) & mask;
+        }
+        return npos;
+    }
+
+    size_t find_index(const Key &key, uint64_t hash) const
+    {
+        size_t pos = find_bucket(key, hash);
+        return pos == npos ? npos : buckets_[pos].entry_index;
+    }
+
+    // Position of the bucket that points at entry index, given its key's hash
+    size_t bucket_of_index(uint64_t hash, size_t index) const
+    {
+        const size_t mask = capacity_ - 1;
+        size_t pos = detail::probe_hash(hash) & mask;
+        while (buckets_[pos].entry_index != index || !buckets_[pos].is_occupied())
+        {
+            pos = (pos + 1) & mask;
+        }
+        return pos;
+    }
+
+    bool insert_bucket(uint64_t hash, size_t index)
+    {
+        detail::Bucket pending;
+        pending.set_occupied(detail::fingerprint_of(hash), 0, index);
+
+        const size_t mask = capacity_ - 1;
+        size_t pos = detail::probe_hash(hash) & mask;
+        size_t distance = 0;
+        while (distance < MAX_DISTANCE)
+        {
+            detail::Bucket &bucket = buckets_[pos];
+            if (!bucket.is_occupied())
+            {
+                pending.distance = distance;
+                bucket = pending;
+                return true;
+            }
+            if (bucket.distance < distance)
+            {
+                pending.distance = distance;
+                distance = bucket.distance;
+                std::swap(bucket, pending);
+            }
+            pos = (pos + 1) & mask;
+            ++distance;
+        }
+        return false;
+    }
+
+    // Backward-shift deletion: the following run moves one bucket closer to
+    // home until an empty bucket or one already at home.
+    void remove_bucket(size_t pos)
+    {
+        const size_t mask = capacity_ - 1;
+        size_t next = (pos + 1) & mask;
+        while (buckets_[next].is_occupied() && buckets_[next].distance > 0)
+        {
+            buckets_[pos] = buckets_[next];
+            buckets_[pos].distance -= 1;
+            pos = next;
+            next = (next + 1) & mask;
+        }
+        buckets_[pos].clear();
+    }
+
+    // Rebuilds the index from the key column; values are not touched.
+    void rehash(size_t new_capacity)
+    {
+        while (true)
+        {
+            capacity_ = new_capacity;
+            buckets_.assign(capacity_, detail::Bucket{});
+
+            bool placed_all = true;
+            for (size_t i = 0; i < keys_.size() && placed_all; ++i)
+            {
+                placed_all = insert_bucket(Hash::hash(keys_[i]), i);
+            }
+
+            if (placed_all)
+            {
+                return;
+            }
+            new_capacity *= 2;
+        }
+    }
+};
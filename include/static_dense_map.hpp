@@ -0,0 +1,253 @@
+#pragma once
+
+#include "unordered_dense_map.hpp"
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+// Fixed-capacity map with all storage inside the object: up to N entries,
+// dense as in unordered_dense_map, behind a detail::Bucket robin-hood index
+// whose size is a compile-time power of two at most 3/4 full. It never
+// allocates and never rehashes, so it can live on the stack in an inner
+// loop. An insert into a full map fails instead of growing: try_emplace
+// returns {end(), false}, while an existing key returns {its entry, false}.
+//
+// Erase moves the last entry into the hole and shifts the following buckets
+// back, so there are no tombstones and every probe stops early. Key and
+// Value must be default constructible.
+template <typename Key, typename Value, size_t N, typename Hash = detail::hash_traits<Key>>
+class static_dense_map
+{
+    static_assert(N > 0, "static_dense_map needs a capacity");
+
+public:
+    struct Entry
+    {
+        Key key;
+        Value value;
+    };
+
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = Entry;
+    using size_type = size_t;
+    using iterator = Entry *;
+    using const_iterator = const Entry *;
+
+    static constexpr size_t CAPACITY = std::bit_ceil(N + (N + 2) / 3); // At most 3/4 full
+
+private:
+    static constexpr size_t MASK = CAPACITY - 1;
+    static constexpr size_t MAX_DISTANCE = 255;
+
+    std::array<Entry, N> entries_;
+    std::array<detail::Bucket, CAPACITY> buckets_{};
+    size_t size_ = 0;
+
+public:
+    bool empty() const { return size_ == 0; }
+    bool full() const { return size_ == N; }
+    size_type size() const { return size_; }
+    static constexpr size_type max_size() { return N; }
+    static constexpr size_type bucket_count() { return CAPACITY; }
+
+    iterator begin() { return entries_.data(); }
+    iterator end() { return entries_.data() + size_; }
+    const_iterator begin() const { return entries_.data(); }
+    const_iterator end() const { return entries_.data() + size_; }
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args)
+    {
+        return try_emplace_hashed(key, Hash::hash(key), std::forward<Args>(args)...);
+    }
+
+    // Same as try_emplace for callers that already hold Hash::hash(key).
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace_hashed(const Key &key, uint64_t hash, Args &&...args)
+    {
+        const size_t existing = find_index(key, hash);
+        if (existing != npos)
+        {
+            return {begin() + existing, false};
+        }
+        if (size_ == N || !probe_fits(hash))
+        {
+            return {end(), false};
+        }
+        // The entry goes in first: if constructing it throws, no bucket
+        // points at the slot yet
+        entries_[size_] = Entry{key, Value(std::forward<Args>(args)...)};
+        insert_bucket(hash, size_);
+        return {begin() + size_++, true};
+    }
+
+    std::pair<iterator, bool> insert(const Key &key, const Value &value) { return try_emplace(key, value); }
+
+    iterator find(const Key &key)
+    {
+        const size_t index = find_index(key, Hash::hash(key));
+        return index == npos ? end() : begin() + index;
+    }
+    const_iterator find(const Key &key) const
+    {
+        const size_t index = find_index(key, Hash::hash(key));
+        return index == npos ? end() : begin() + index;
+    }
+    bool contains(const Key &key) const { return find_index(key, Hash::hash(key)) != npos; }
+    size_type count(const Key &key) const { return contains(key) ? 1 : 0; }
+
+    Value &at(const Key &key)
+    {
+        auto it = find(key);
+        if (it == end())
+            throw std::out_of_range("Key not found");
+        return it->value;
+    }
+    const Value &at(const Key &key) const
+    {
+        auto it = find(key);
+        if (it == end())
+            throw std::out_of_range("Key not found");
+        return it->value;
+    }
+
+    size_type erase(const Key &key)
+    {
+        const size_t pos = find_bucket(key, Hash::hash(key));
+        if (pos == npos)
+        {
+            return 0;
+        }
+        const size_t index = buckets_[pos].entry_index;
+        remove_bucket(pos);
+
+        const size_t last = size_ - 1;
+        if (index != last)
+        {
+            entries_[index] = std::move(entries_[last]);
+            buckets_[bucket_of_index(Hash::hash(entries_[index].key), last)].entry_index = index;
+        }
+        --size_;
+        return 1;
+    }
+
+    void clear()
+    {
+        buckets_.fill(detail::Bucket{});
+        size_ = 0;
+    }
+
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    // Without tombstones a probe stops at the first bucket that is empty or
+    // closer to its home than the key would be.
+    size_t find_bucket(const Key &key, uint64_t hash) const
+    {
+        const uint8_t fingerprint = detail::fingerprint_of(hash);
+        size_t pos = detail::probe_hash(hash) & MASK;
+        for (size_t distance = 0;; ++distance)
+        {
+            const detail::Bucket &bucket = buckets_[pos];
+            if (!bucket.is_occupied() || bucket.distance < distance)
+            {
+                return npos;
+            }
+            if (bucket.fingerprint == fingerprint && entries_[bucket.entry_index].key == key)
+            {
+                return pos;
+            }
+            pos = (pos + 1) & MASK;
+        }
+    }
+
+    size_t find_index(const Key &key, uint64_t hash) const
+    {
+        const size_t pos = find_bucket(key, hash);
+        return pos == npos ? npos : buckets_[pos].entry_index;
+    }
+
+    size_t bucket_of_index(uint64_t hash, size_t index) const
+    {
+        size_t pos = detail::probe_hash(hash) & MASK;
+        while (!buckets_[pos].is_occupied() || buckets_[pos].entry_index != index)
+        {
+            pos = (pos + 1) & MASK;
+        }
+        return pos;
+    }
+
+    // Robin-hood insertion; the caller has checked probe_fits(hash).
+    void insert_bucket(uint64_t hash, size_t index)
+    {
+        detail::Bucket pending;
+        pending.set_occupied(detail::fingerprint_of(hash), 0, index);
+
+        size_t pos = detail::probe_hash(hash) & MASK;
+        size_t distance = 0;
+        while (true)
+        {
+            detail::Bucket &bucket = buckets_[pos];
+            if (!bucket.is_occupied())
+            {
+                pending.distance = distance;
+                bucket = pending;
+                return;
+            }
+            if (bucket.distance < distance)
+            {
+                pending.distance = distance;
+                distance = bucket.distance;
+                std::swap(bucket, pending);
+            }
+            pos = (pos + 1) & MASK;
+            ++distance;
+        }
+    }
+
+    // The index cannot grow, so a key whose probe would push some bucket
+    // past MAX_DISTANCE is refused up front. Every swap in insert_bucket
+    // reads buckets the walk has not written yet, so the distances can be
+    // traced without writing; the walk is needed only when the array is
+    // longer than MAX_DISTANCE.
+    bool probe_fits(uint64_t hash) const
+    {
+        if constexpr (CAPACITY <= MAX_DISTANCE + 1)
+        {
+            return true;
+        }
+        size_t pos = detail::probe_hash(hash) & MASK;
+        size_t distance = 0;
+        while (buckets_[pos].is_occupied())
+        {
+            if (buckets_[pos].distance < distance)
+            {
+                distance = buckets_[pos].distance;
+            }
+            pos = (pos + 1) & MASK;
+            if (++distance > MAX_DISTANCE)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Backward-shift deletion
+    void remove_bucket(size_t pos)
+    {
+        size_t next = (pos + 1) & MASK;
+        while (buckets_[next].is_occupied() && buckets_[next].distance > 0)
+        {
+            buckets_[pos] = buckets_[next];
+            buckets_[pos].distance -= 1;
+            pos = next;
+            next = (next + 1) & MASK;
+        }
+        buckets_[pos].clear();
+    }
+};
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "unordered_dense_map.hpp"
+#include "parallel_for.hpp"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Hands every thread a private unordered_dense_map to accumulate into without
+// synchronisation, then merges the per-thread maps in parallel. The merge
+// hashes each key exactly once: entries are scattered into partitions by the
+// high hash bits, each partition is combined by a single thread, and the
+// partition results are stitched together with the hashes already computed.
+//
+// local() and add() may be called from any number of threads; merge() and
+// merge_into() must only run once those threads are done.
+template <typename Key, typename Value, typename Combine = std::plus<Value>, typename Hash = detail::hash_traits<Key>>
+class thread_local_aggregator
+{
+public:
+    using map_type = unordered_dense_map<Key, Value, Hash>;
+
+private:
+    static constexpr size_t SCATTER_CHUNK = 16384;
+    static constexpr size_t PARTITIONS_PER_THREAD = 4;
+    static constexpr size_t MAX_CACHED_AGGREGATORS = 16;
+
+    struct Record
+    {
+        map_type *source;
+        size_t index;
+        uint64_t hash;
+    };
+
+    struct Partition
+    {
+        map_type map;
+        std::vector<uint64_t> hashes; // hashes[i] belongs to the map's i-th entry
+    };
+
+    struct CacheSlot
+    {
+        uint64_t owner;
+        map_type *map;
+    };
+
+    Combine combine_;
+    uint64_t id_;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<map_type>> locals_;
+
+    static uint64_t next_id()
+    {
+        static std::atomic<uint64_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    // Ids are never reused, so slots left behind by destroyed aggregators can
+    // never match a live one.
+    static std::vector<CacheSlot> &thread_cache()
+    {
+        thread_local std::vector<CacheSlot> cache;
+        return cache;
+    }
+
+    static size_t partition_of(uint64_t hash, size_t partition_count)
+    {
+        return static_cast<size_t>(((hash >> 32) * partition_count) >> 32);
+    }
+
+public:
+    explicit thread_local_aggregator(Combine combine = Combine{})
+        : combine_(std::move(combine)), id_(next_id()) {}
+
+    thread_local_aggregator(const thread_local_aggregator &) = delete;
+    thread_local_aggregator &operator=(const thread_local_aggregator &) = delete;
+
+    // The calling thread's private map.
+    map_type &local()
+    {
+        auto &cache = thread_cache();
+        for (const auto &slot : cache)
+        {
+            if (slot.owner == id_)
+            {
+                return *slot.map;
+            }
+        }
+
+        auto map = std::make_unique<map_type>();
+        map_type *raw = map.get();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            locals_.push_back(std::move(map));
+        }
+
+        if (cache.size() >= MAX_CACHED_AGGREGATORS)
+        {
+            cache.erase(cache.begin());
+        }
+        cache.push_back({id_, raw});
+        return *raw;
+    }
+
+    void add(const Key &key, const Value &value)
+    {
+        auto [it, inserted] = local().try_emplace(key, value);
+        if (!inserted)
+        {
+            it->value = combine_(it->value, value);
+        }
+    }
+
+    // Combines every thread's map into one. The per-thread maps are left empty
+    // (keeping their capacity) so the threads can start the next round.
+    map_type merge(size_t threads = 0)
+    {
+        threads = detail::resolve_thread_count(threads);
+        std::vector<Partition> partitions = partition_and_combine(threads);
+
+        size_t total = 0;
+        for (const auto &part : partitions)
+        {
+            total += part.map.size();
+        }
+
+        map_type result;
+        result.reserve(total);
+        for (auto &part : partitions)
+        {
+            size_t i = 0;
+            for (auto &entry : part.map)
+            {
+                result.try_emplace_hashed(entry.key, part.hashes[i++], std::move(entry.value));
+            }
+        }
+        return result;
+    }
+
+    // Merges into a thread-safe map such as concurrent_unordered_dense_map,
+    // one partition per task. Partitions hold disjoint keys, so every target
+    // key is inserted exactly once; keys already in the target are kept.
+    template <typename ConcurrentMap>
+    void merge_into(ConcurrentMap &target, size_t threads = 0)
+    {
+        threads = detail::resolve_thread_count(threads);
+        std::vector<Partition> partitions = partition_and_combine(threads);
+
+        detail::parallel_for(partitions.size(), threads, [&](size_t p)
+                             {
+            for (const auto &entry : partitions[p].map)
+            {
+                target.insert(entry.key, entry.value);
+            } });
+    }
+
+private:
+    std::vector<Partition> partition_and_combine(size_t threads)
+    {
+        std::vector<map_type *> sources;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto &local : locals_)
+            {
+                if (!local->empty())
+                {
+                    sources.push_back(local.get());
+                }
+            }
+        }
+
+        struct Chunk
+        {
+            map_type *source;
+            size_t begin;
+            size_t end;
+        };
+
+        std::vector<Chunk> chunks;
+        for (map_type *source : sources)
+        {
+            for (size_t begin = 0; begin < source->size(); begin += SCATTER_CHUNK)
+            {
+                chunks.push_back({source, begin, std::min(begin + SCATTER_CHUNK, source->size())});
+            }
+        }
+
+        const size_t partition_count = threads * PARTITIONS_PER_THREAD;
+
+        // Phase 1: hash every key once and scatter it by the high hash bits
+        std::vector<std::vector<std::vector<Record>>> scattered(chunks.size());
+        detail::parallel_for(chunks.size(), threads, [&](size_t c)
+                             {
+            const Chunk &chunk = chunks[c];
+            auto &out = scattered[c];
+            out.resize(partition_count);
+            for (size_t i = chunk.begin; i < chunk.end; ++i)
+            {
+                const Key &key = chunk.source->entry_at(i).key;
+                uint64_t hash = Hash::hash(key);
+                out[partition_of(hash, partition_count)].push_back({chunk.source, i, hash});
+            } });
+
+        // Phase 2: each partition is combined by exactly one task
+        std::vector<Partition> partitions(partition_count);
+        detail::parallel_for(partition_count, threads, [&](size_t p)
+                             {
+            Partition &part = partitions[p];
+
+            size_t expected = 0;
+            for (const auto &chunk_out : scattered)
+            {
+                expected += chunk_out[p].size();
+            }
+            part.map.reserve(expected);
+            part.hashes.reserve(expected);
+
+            for (auto &chunk_out : scattered)
+            {
+                for (const Record &rec : chunk_out[p])
+                {
+                    auto &entry = rec.source->entry_at(rec.index);
+                    auto [it, inserted] = part.map.try_emplace_hashed(entry.key, rec.hash, std::move(entry.value));
+                    if (inserted)
+                    {
+                        part.hashes.push_back(rec.hash);
+                    }
+                    else
+                    {
+                        it->value = combine_(it->value, entry.value);
+                    }
+                }
+            } });
+
+        for (map_type *source : sources)
+        {
+            source->clear();
+        }
+        return partitions;
+    }
+};
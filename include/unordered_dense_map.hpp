@@ -11,6 +11,59 @@
 #include <stdexcept>
 #include <iterator>
 #include <algorithm>
+#include <optional>
+#include <numeric>
+#include <span>
+#include <ranges>
+#include "parallel_for.hpp"
+#include "radix_sort.hpp"
+#include "chunked_storage.hpp"
+#include "bloom_filter.hpp"
+
+// Fold operators for unordered_dense_map::aggregate. init(x) builds the value
+// for a key's first row, op(acc, x) folds every later row into it.
+namespace dense_aggregate
+{
+    struct sum
+    {
+        template <typename T>
+        T init(const T &x) const { return x; }
+        template <typename A, typename T>
+        void operator()(A &acc, const T &x) const { acc += x; }
+    };
+
+    struct count
+    {
+        template <typename T>
+        size_t init(const T &) const { return 1; }
+        template <typename A, typename T>
+        void operator()(A &acc, const T &) const { ++acc; }
+    };
+
+    struct min
+    {
+        template <typename T>
+        T init(const T &x) const { return x; }
+        template <typename A, typename T>
+        void operator()(A &acc, const T &x) const
+        {
+            if (x < acc)
+                acc = x;
+        }
+    };
+
+    struct max
+    {
+        template <typename T>
+        T init(const T &x) const { return x; }
+        template <typename A, typename T>
+        void operator()(A &acc, const T &x) const
+        {
+            if (acc < x)
+                acc = x;
+        }
+    };
+}
 
 namespace detail
 {
@@ -47,6 +100,23 @@ namespace detail
 
     uint64_t mix_hash(uint64_t hash);
 
+    // Read hint for memory the caller is about to touch
+    inline void prefetch(const void *address)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address);
+#else
+        (void)address;
+#endif
+    }
+
+    // Default for union_with: the value already in the map wins
+    struct keep_existing
+    {
+        template <typename V>
+        const V &operator()(const V &existing, const V &) const { return existing; }
+    };
+
     struct Bucket
     {
         uint64_t fingerprint : 8;  // 8-bit fingerprint for quick comparison
@@ -55,13 +125,13 @@ namespace detail
         uint64_t tombstone : 1;    // Whether bucket is a tombstone
         uint64_t entry_index : 46; // Index into entries_ vector (up to 70 trillion entries)
 
-        Bucket() : fingerprint(0), distance(0), occupied(0), tombstone(0), entry_index(0) {}
+        constexpr Bucket() : fingerprint(0), distance(0), occupied(0), tombstone(0), entry_index(0) {}
 
-        bool is_empty() const { return !occupied && !tombstone; }
-        bool is_tombstone() const { return !occupied && tombstone; }
-        bool is_occupied() const { return occupied; }
+        constexpr bool is_empty() const { return !occupied && !tombstone; }
+        constexpr bool is_tombstone() const { return !occupied && tombstone; }
+        constexpr bool is_occupied() const { return occupied; }
 
-        void clear()
+        constexpr void clear()
         {
             fingerprint = 0;
             distance = 0;
@@ -70,7 +140,7 @@ namespace detail
             entry_index = 0;
         }
 
-        void set_occupied(uint8_t fp, uint8_t dist, size_t idx)
+        constexpr void set_occupied(uint8_t fp, uint8_t dist, size_t idx)
         {
             fingerprint = fp;
             distance = dist;
@@ -79,15 +149,31 @@ namespace detail
             entry_index = idx;
         }
 
-        void set_tombstone()
+        constexpr void set_tombstone()
         {
             occupied = 0;
             tombstone = 1;
         }
     };
+
+    // Bucket fingerprints come from the top of a multiplicative mix rather
+    // than the low byte: the low bits also pick the bucket, so keys sharing a
+    // home bucket would otherwise always share a fingerprint and every
+    // collision would cost a key comparison. Every map built on Bucket uses
+    // this rule.
+    constexpr uint8_t fingerprint_of(uint64_t hash)
+    {
+        return static_cast<uint8_t>((hash * 0x9E3779B97F4A7C15ull) >> 56);
+    }
+
+    // Hash whose low bits pick the home bucket. Hashes whose low byte is zero
+    // are remixed first, as they tend to come from poor-quality hash
+    // functions.
+    inline uint64_t probe_hash(uint64_t hash) { return (hash & 0xFF) == 0 ? mix_hash(hash) : hash; }
 }
 
-template <typename Key, typename Value, typename Hash = detail::hash_traits<Key>>
+template <typename Key, typename Value, typename Hash = detail::hash_traits<Key>,
+          typename Storage = dense_storage::contiguous>
 class unordered_dense_map
 {
 private:
@@ -105,8 +191,8 @@ private:
         Entry(Key &&k, Value &&v) : key(std::move(k)), value(std::move(v)) {}
     };
 
-    std::vector<detail::Bucket> buckets_;
-    std::vector<Entry> entries_;
+    typename Storage::template bucket_container<detail::Bucket> buckets_;
+    typename Storage::template entry_container<Entry> entries_;
     size_t size_;
     size_t capacity_;
 
@@ -116,6 +202,25 @@ public:
     using value_type = Entry;
     using size_type = size_t;
 
+    // Opt-in automatic shrinking, see set_shrink_policy.
+    struct shrink_policy
+    {
+        float low_water = 0.0f; // Load factor below which erase shrinks; 0 never shrinks
+    };
+
+private:
+    // A shrink lands at a load factor above MAX_LOAD_FACTOR / 2, so a low
+    // water mark at most half of that leaves a wide band between the shrink
+    // and the next growth, and the capacity cannot oscillate.
+    static constexpr float MAX_LOW_WATER = MAX_LOAD_FACTOR / 4;
+
+    shrink_policy shrink_policy_;
+
+    bool use_bloom_ = false;
+    detail::blocked_bloom_filter bloom_;
+
+public:
+
     unordered_dense_map() : size_(0), capacity_(INITIAL_CAPACITY)
     {
         buckets_.resize(capacity_);
@@ -125,9 +230,20 @@ public:
     unordered_dense_map &operator=(const unordered_dense_map &other) = default;
     unordered_dense_map &operator=(unordered_dense_map &&other) = default;
 
+    // Copy for a reader on another thread while this map keeps changing. With
+    // dense_storage::copy_on_write it costs O(number of chunks): both maps
+    // share every chunk until one of them writes to it. Take it on the thread
+    // that mutates the map, like any other copy.
+    unordered_dense_map snapshot() const
+        requires Storage::cheap_copy
+    {
+        return *this;
+    }
+
     bool empty() const { return size_ == 0; }
     size_type size() const { return size_; }
     size_type max_size() const { return std::numeric_limits<size_type>::max(); }
+    size_type bucket_count() const { return capacity_; }
 
     Value &operator[](const Key &key)
     {
@@ -159,6 +275,9 @@ public:
 
         iterator(unordered_dense_map *map, size_t index) : map_(map), index_(index) {}
 
+        // Position of the entry in the dense array, as used by entry_at.
+        size_t index() const { return index_; }
+
         Entry &operator*()
         {
             if (index_ >= map_->entries_.size())
@@ -195,6 +314,8 @@ public:
 
         const_iterator(const unordered_dense_map *map, size_t index) : map_(map), index_(index) {}
 
+        size_t index() const { return index_; }
+
         const Entry &operator*() const
         {
             if (index_ >= map_->entries_.size())
@@ -230,6 +351,61 @@ public:
     const_iterator cbegin() const { return const_iterator(this, 0); }
     const_iterator cend() const { return const_iterator(this, size_); }
 
+    // Read-only walk over the entries in ascending key order. Backed by an
+    // index permutation, so the map itself is left untouched; any change to
+    // the map invalidates the view.
+    class sorted_view_type
+    {
+    public:
+        class iterator
+        {
+        public:
+            const unordered_dense_map *map_;
+            const size_t *position_;
+
+            iterator(const unordered_dense_map *map, const size_t *position) : map_(map), position_(position) {}
+
+            const Entry &operator*() const { return map_->entries_[*position_]; }
+            const Entry *operator->() const { return &map_->entries_[*position_]; }
+
+            iterator &operator++()
+            {
+                ++position_;
+                return *this;
+            }
+            iterator operator++(int)
+            {
+                iterator tmp = *this;
+                ++position_;
+                return tmp;
+            }
+            bool operator==(const iterator &other) const { return position_ == other.position_; }
+            bool operator!=(const iterator &other) const { return !(*this == other); }
+        };
+
+        sorted_view_type(const unordered_dense_map *map, std::vector<size_t> order)
+            : map_(map), order_(std::move(order)) {}
+
+        size_type size() const { return order_.size(); }
+        bool empty() const { return order_.empty(); }
+        const Entry &operator[](size_t i) const { return map_->entries_[order_[i]]; }
+        iterator begin() const { return iterator(map_, order_.data()); }
+        iterator end() const { return iterator(map_, order_.data() + order_.size()); }
+
+        // Entry indices (iteration positions of the map) in key order
+        const std::vector<size_t> &permutation() const { return order_; }
+
+    private:
+        const unordered_dense_map *map_;
+        std::vector<size_t> order_;
+    };
+
+    // Integral, enum and IEEE floating-point keys are ordered with an LSD
+    // radix sort over the dense entries; other keys fall back to std::sort
+    // with operator<.
+    sorted_view_type sorted_view() const { return sorted_view_type(this, sorted_order()); }
+    std::vector<std::pair<Key, Value>> export_sorted() const;
+
     std::pair<iterator, bool> insert(const value_type &value) { return emplace(value.key, value.value); }
     std::pair<iterator, bool> insert(value_type &&value) { return emplace(std::move(value.key), std::move(value.value)); }
 
@@ -249,33 +425,249 @@ public:
     }
 
     template <typename... Args>
-    std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args);
+    std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args)
+    {
+        return try_emplace_hashed(key, Hash::hash(key), std::forward<Args>(args)...);
+    }
+
+    // Same as try_emplace for callers that already hold Hash::hash(key).
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace_hashed(const Key &key, uint64_t hash, Args &&...args);
+
+    // Same as insert for callers that already hold Hash::hash(key).
+    std::pair<iterator, bool> insert_hashed(const Key &key, uint64_t hash, const Value &value)
+    {
+        return try_emplace_hashed(key, hash, value);
+    }
+
+    size_type erase(const Key &key) { return erase_hashed(key, Hash::hash(key)); }
+    size_type erase_hashed(const Key &key, uint64_t hash);
 
-    size_type erase(const Key &key);
+    // Entries by position in the dense array, 0 <= index < size(), in
+    // iteration order. Erasing moves the last entry into the erased
+    // position. erase_at finds the bucket by position rather than by key,
+    // so nothing it reads can alias the entry being removed.
+    Entry &entry_at(size_type index) { return entries_[index]; }
+    const Entry &entry_at(size_type index) const { return entries_[index]; }
+    void erase_at(size_type index);
     void clear()
     {
         buckets_.clear();
         entries_.clear();
         buckets_.resize(capacity_);
         size_ = 0;
+        if (use_bloom_)
+        {
+            bloom_.reset(bloom_blocks_for(capacity_));
+        }
     }
 
-    iterator find(const Key &key);
-    const_iterator find(const Key &key) const;
+    // Grows the bucket array so that count elements fit without a rehash.
+    void reserve(size_type count);
+
+    // Rebuilds the index at the smallest capacity that holds size(), which
+    // also drops tombstones, and releases unused entry storage.
+    void shrink_to_fit();
+
+    // Once set, an erase that leaves the load factor below policy.low_water
+    // calls shrink_to_fit(). low_water must lie in [0, 0.1875].
+    void set_shrink_policy(shrink_policy policy)
+    {
+        if (!(policy.low_water >= 0.0f && policy.low_water <= MAX_LOW_WATER))
+            throw std::invalid_argument("low_water must lie in [0, 0.1875]");
+        shrink_policy_ = policy;
+    }
+    shrink_policy get_shrink_policy() const { return shrink_policy_; }
+
+    // Opt-in Bloom filter in front of the bucket index, for miss-heavy
+    // lookups: find, contains, batch_contains and the other lookups test one
+    // cache line of filter before probing, so most absent keys never touch a
+    // bucket. It costs about 8 bits per bucket, is updated on insert and is
+    // rebuilt on every rehash, which also drops the bits of erased keys.
+    void set_bloom_filter(bool enabled);
+    bool has_bloom_filter() const { return use_bloom_; }
+
+    iterator find(const Key &key) { return find_hashed(key, Hash::hash(key)); }
+    const_iterator find(const Key &key) const { return find_hashed(key, Hash::hash(key)); }
+    iterator find_hashed(const Key &key, uint64_t hash);
+    const_iterator find_hashed(const Key &key, uint64_t hash) const;
+
+    // Pulls the home bucket of hash into cache. Issued a few keys ahead of
+    // the matching find_hashed, it overlaps the miss with other work.
+    void prefetch(uint64_t hash) const { detail::prefetch(&buckets_[detail::probe_hash(hash) % capacity_]); }
     size_type count(const Key &key) const { return find(key) != end() ? 1 : 0; }
     bool contains(const Key &key) const { return find(key) != end(); }
 
     template <typename InputIt>
     void batch_insert(InputIt first, InputIt last);
 
+    // Opt-in multi-threaded variants for very large tables; threads == 0
+    // uses every hardware thread. The bucket array is cut into disjoint
+    // ranges that are filled without synchronisation; the few elements that
+    // spill past the end of their range are placed serially afterwards.
+    void parallel_rehash(size_type bucket_count, size_t threads = 0);
+
+    // Bulk insert of (key, value) pairs. Entries are written in parallel when
+    // the iterators are random access; single-pass input iterators are read
+    // once. Like insert, the first occurrence of a key wins, including keys
+    // already in the map.
+    template <typename InputIt>
+    void parallel_build(InputIt first, InputIt last, size_t threads = 0);
+
+    // Single-threaded bulk insert for tables much larger than the last-level
+    // cache. The input is radix-partitioned by the high bits of each key's
+    // bucket position, then the bucket array is filled one cache-sized slice
+    // at a time, so the random writes of a plain insert loop become
+    // cache-resident. Same first-occurrence-wins semantics as insert.
+    template <std::ranges::forward_range Range>
+        requires std::ranges::common_range<const Range>
+    void build_partitioned(const Range &range)
+    {
+        parallel_build(std::ranges::begin(range), std::ranges::end(range), 1);
+    }
+
     template <typename InputIt, typename OutputIt>
     void batch_find(InputIt keys_first, InputIt keys_last, OutputIt results_first);
 
     template <typename InputIt>
     std::vector<bool> batch_contains(InputIt first, InputIt last);
 
+    // Looks up a range of keys in blocks: every key of a block is hashed and
+    // its home bucket prefetched, then matching entries are prefetched, and
+    // only then are the probes run. f(position, const value_type *) is called
+    // in input order, with nullptr for absent keys.
+    template <typename ForwardIt, typename F>
+    void batch_lookup(ForwardIt first, ForwardIt last, F f) const;
+
+    // Set algebra. Each operation walks the smaller map's dense entries where
+    // it can and probes the other with batch lookups; the policy overloads
+    // split the probing across threads. Results take their values from *this.
+    unordered_dense_map intersect(const unordered_dense_map &other) const;
+    template <detail::execution_policy Policy>
+    unordered_dense_map intersect(const Policy &policy, const unordered_dense_map &other) const;
+
+    unordered_dense_map difference(const unordered_dense_map &other) const; // keys only in *this
+    template <detail::execution_policy Policy>
+    unordered_dense_map difference(const Policy &policy, const unordered_dense_map &other) const;
+
+    unordered_dense_map symmetric_difference(const unordered_dense_map &other) const;
+    template <detail::execution_policy Policy>
+    unordered_dense_map symmetric_difference(const Policy &policy, const unordered_dense_map &other) const;
+
+    // Adds other's keys to *this in place; for keys in both maps the value
+    // becomes combine(value, other_value). The policy overload calls combine
+    // from several threads at once, each on a different entry, so combine
+    // must be safe to call concurrently (a stateless functor is).
+    template <typename Combine = detail::keep_existing>
+    void union_with(const unordered_dense_map &other, Combine combine = Combine{});
+    template <detail::execution_policy Policy, typename Combine = detail::keep_existing>
+    void union_with(const Policy &policy, const unordered_dense_map &other, Combine combine = Combine{});
+
+    // GROUP BY over columns: folds values[i] into the entry for keys[i] with
+    // op, e.g. dense_aggregate::sum{}. Rows are processed in blocks: a block
+    // is hashed and prefetched before it is probed, and block_size bounds the
+    // in-flight working set so it stays in L2. op may be a plain functor
+    // op(Value &, x) without init(), in which case new keys start at Value{}.
+    template <std::ranges::contiguous_range Values, typename Op>
+    void aggregate(std::span<const Key> keys, const Values &values, Op op,
+                   size_t block_size = AGGREGATE_BLOCK);
+
+    // For operators that ignore the row value, such as dense_aggregate::count
+    template <typename Op>
+    void aggregate(std::span<const Key> keys, Op op, size_t block_size = AGGREGATE_BLOCK);
+
+    // Whole-map algorithms that walk the dense entry array directly. The
+    // policy overloads split it into fixed-size chunks; with
+    // dense_execution::par the chunks run on several threads, so callbacks
+    // must be safe to call concurrently and reduce's combine associative.
+    template <typename F>
+    void for_each(F f); // f(const Key &, Value &)
+    template <detail::execution_policy Policy, typename F>
+    void for_each(const Policy &policy, F f);
+
+    template <typename F>
+    void transform_values(F f); // value = f(value)
+    template <detail::execution_policy Policy, typename F>
+    void transform_values(const Policy &policy, F f);
+
+    template <typename Pred>
+    size_type count_if(Pred pred) const; // pred(const Key &, const Value &)
+    template <detail::execution_policy Policy, typename Pred>
+    size_type count_if(const Policy &policy, Pred pred) const;
+
+    // combine(init, proj(key, value)) folded over every entry
+    template <typename T, typename Combine, typename Proj>
+    T reduce(T init, Combine combine, Proj proj) const;
+    template <detail::execution_policy Policy, typename T, typename Combine, typename Proj>
+    T reduce(const Policy &policy, T init, Combine combine, Proj proj) const;
+
 private:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    size_t find_index(const Key &key, uint64_t hash) const;
+
+    // One 512-bit filter block per 64 buckets
+    static size_t bloom_blocks_for(size_t capacity) { return std::max<size_t>(1, capacity / 64); }
+    void rebuild_bloom();
+    size_t bucket_of_index(uint64_t hash, size_t entry_index) const;
+    void remove_entry(detail::Bucket &bucket, size_t entry_index);
+
+    template <typename... Args>
+    std::pair<iterator, bool> emplace_unique(const Key &key, uint64_t hash, Args &&...args);
+
+    bool insert_bucket(uint64_t hash, size_t entry_index);
     void rehash(size_t new_capacity);
+    size_t capacity_for(size_t count) const;
+    void parallel_rebuild_index(size_t new_capacity, size_t threads, bool deduplicate);
+
+    // Copy-on-write storage copies a shared chunk on its first write. Threads
+    // writing disjoint entries may still share a chunk, so parallel writers
+    // take the copies up front.
+    void detach_entries()
+    {
+        if constexpr (requires { entries_.detach(); })
+        {
+            entries_.detach();
+        }
+    }
+
+    static constexpr size_t ALGORITHM_CHUNK = 16384;
+
+    // Calls f(chunk, begin, end) for consecutive entry ranges.
+    template <typename Policy, typename F>
+    void for_each_chunk(const Policy &policy, F &&f) const;
+
+    std::vector<size_t> sorted_order() const;
+
+    static constexpr size_t LOOKUP_BLOCK = 32;
+    static constexpr size_t PARTITION_BUCKETS = 32768; // 256 KiB slice of buckets_
+    static constexpr size_t AGGREGATE_BLOCK = 256;
+
+    // Prefetching probe loop behind batch_lookup: f(i, hash, entry_index)
+    // for i in [0, count), entry_index == npos when key_at(i) is absent.
+    // Every probe of a block runs after f has seen the previous row, so f may
+    // insert.
+    template <typename KeyAt, typename F>
+    void lookup_pipeline(size_t count, KeyAt &&key_at, F &&f, size_t block_size = LOOKUP_BLOCK) const;
+
+    // lookup_pipeline over an iterator range: f(position, entry_index)
+    template <typename ForwardIt, typename F>
+    void lookup_range(ForwardIt first, ForwardIt last, F &&f) const;
+
+    template <typename ValueAt, typename Op>
+    void aggregate_rows(std::span<const Key> keys, ValueAt &&value_at, Op &op, size_t block_size);
+
+    struct ProbeHit
+    {
+        size_t source_index; // Entry in the map that was walked
+        size_t found_index;  // Entry in the probed map, or npos
+        uint64_t hash;
+    };
+
+    // Walks source's entries, probes *this for each, and returns those whose
+    // presence matches `present`, in source order.
+    template <typename Policy>
+    std::vector<ProbeHit> probe_entries_of(const Policy &policy, const unordered_dense_map &source, bool present) const;
 };
 
 #include "unordered_dense_map_impl.hpp"
\ No newline at end of file
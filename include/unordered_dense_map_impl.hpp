@@ -3,33 +3,59 @@
 #include "unordered_dense_map.hpp"
 
 // Template method implementations
-template <typename Key, typename Value, typename Hash>
+template <typename Key, typename Value, typename Hash, typename Storage>
 template <typename... Args>
-std::pair<typename unordered_dense_map<Key, Value, Hash>::iterator, bool>
-unordered_dense_map<Key, Value, Hash>::try_emplace(const Key &key, Args &&...args)
+std::pair<typename unordered_dense_map<Key, Value, Hash, Storage>::iterator, bool>
+unordered_dense_map<Key, Value, Hash, Storage>::try_emplace_hashed(const Key &key, uint64_t hash, Args &&...args)
+{
+    // Tombstones break the robin-hood early-exit invariant, so look the key up
+    // over its whole probe sequence before claiming a slot.
+    size_t existing = find_index(key, hash);
+    if (existing != npos)
+    {
+        return {iterator(this, existing), false};
+    }
+
+    return emplace_unique(key, hash, std::forward<Args>(args)...);
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename... Args>
+std::pair<typename unordered_dense_map<Key, Value, Hash, Storage>::iterator, bool>
+unordered_dense_map<Key, Value, Hash, Storage>::emplace_unique(const Key &key, uint64_t hash, Args &&...args)
 {
     if (size_ >= capacity_ * MAX_LOAD_FACTOR)
     {
         rehash(capacity_ * 2);
     }
 
-    uint64_t hash = Hash::hash(key);
-    uint8_t fingerprint = Hash::fingerprint(key);
+    // New entries always go to the back; robin-hood displacement only moves
+    // bucket metadata, so entry indices never change on insert.
+    size_t entry_idx = entries_.size();
+    entries_.emplace_back(Key(key), Value{std::forward<Args>(args)...});
+    ++size_;
 
-    // Mix poor-quality hashes
-    if (fingerprint == 0)
+    if (!insert_bucket(hash, entry_idx))
     {
-        hash = detail::mix_hash(hash);
-        fingerprint = Hash::fingerprint(key);
+        // Probe sequence too long; rehash rebuilds the index from entries_
+        rehash(capacity_ * 2);
+    }
+    else if (use_bloom_)
+    {
+        bloom_.insert(hash);
     }
 
-    size_t ideal_pos = hash % capacity_;
-    size_t current_pos = ideal_pos;
-    size_t distance = 0;
+    return {iterator(this, entry_idx), true};
+}
 
-    // Create copies for potential swapping
-    Key kcopy = key;
-    Value vcopy{std::forward<Args>(args)...};
+template <typename Key, typename Value, typename Hash, typename Storage>
+bool unordered_dense_map<Key, Value, Hash, Storage>::insert_bucket(uint64_t hash, size_t entry_index)
+{
+    detail::Bucket pending;
+    pending.set_occupied(detail::fingerprint_of(hash), 0, entry_index);
+
+    size_t current_pos = detail::probe_hash(hash) % capacity_;
+    size_t distance = 0;
 
     // Find insertion position using robin-hood hashing
     while (distance < MAX_DISTANCE)
@@ -38,85 +64,33 @@ unordered_dense_map<Key, Value, Hash>::try_emplace(const Key &key, Args &&...arg
 
         if (bucket.is_empty() || bucket.is_tombstone())
         {
-            // Found empty slot or tombstone
-            size_t entry_idx = entries_.size();
-            bucket.set_occupied(fingerprint, distance, entry_idx);
-            entries_.emplace_back(std::move(kcopy), std::move(vcopy));
-            ++size_;
-
-            return {iterator(this, entry_idx), true};
-        }
-
-        if (bucket.is_occupied() && bucket.fingerprint == fingerprint)
-        {
-            // Check if it's the same key
-            size_t entry_index = bucket.entry_index;
-            
-            // Validate entry index to prevent segfaults
-            if (entry_index >= entries_.size())
-            {
-                // Bucket corruption detected, skip this bucket
-                current_pos = (current_pos + 1) % capacity_;
-                ++distance;
-                continue;
-            }
-            
-            if (entries_[entry_index].key == kcopy)
-            {
-                return {iterator(this, entry_index), false};
-            }
+            pending.distance = distance;
+            bucket = pending;
+            return true;
         }
 
         // Robin-hood: if current element has traveled less distance, swap them
-        if (bucket.is_occupied() && bucket.distance < distance)
+        if (bucket.distance < distance)
         {
-            // Validate entry index to prevent segfaults
-            size_t entry_index = bucket.entry_index;
-            if (entry_index >= entries_.size())
-            {
-                // Bucket corruption detected, skip this bucket
-                current_pos = (current_pos + 1) % capacity_;
-                ++distance;
-                continue;
-            }
-            
-            // Swap the key-value data in place in the entries array
-            std::swap(kcopy, entries_[entry_index].key);
-            std::swap(vcopy, entries_[entry_index].value);
-
-            // Swap metadata (with proper type conversions)
-            uint8_t tmp_fp = fingerprint;
-            fingerprint = static_cast<uint8_t>(bucket.fingerprint);
-            bucket.fingerprint = tmp_fp;
-
-            uint8_t tmp_dist = static_cast<uint8_t>(distance);
-            distance = static_cast<size_t>(bucket.distance);
-            bucket.distance = tmp_dist;
+            pending.distance = distance;
+            distance = bucket.distance;
+            std::swap(bucket, pending);
         }
 
         current_pos = (current_pos + 1) % capacity_;
         ++distance;
     }
 
-    // If we get here, we need to rehash
-    rehash(capacity_ * 2);
-    return try_emplace(key, std::forward<Args>(args)...);
+    return false;
 }
 
-template <typename Key, typename Value, typename Hash>
-typename unordered_dense_map<Key, Value, Hash>::size_type
-unordered_dense_map<Key, Value, Hash>::erase(const Key &key)
+template <typename Key, typename Value, typename Hash, typename Storage>
+typename unordered_dense_map<Key, Value, Hash, Storage>::size_type
+unordered_dense_map<Key, Value, Hash, Storage>::erase_hashed(const Key &key, uint64_t hash)
 {
-    uint64_t hash = Hash::hash(key);
-    uint8_t fingerprint = Hash::fingerprint(key);
+    uint8_t fingerprint = detail::fingerprint_of(hash);
 
-    if (fingerprint == 0)
-    {
-        hash = detail::mix_hash(hash);
-        fingerprint = Hash::fingerprint(key);
-    }
-
-    size_t ideal_pos = hash % capacity_;
+    size_t ideal_pos = detail::probe_hash(hash) % capacity_;
     size_t current_pos = ideal_pos;
     size_t distance = 0;
 
@@ -153,31 +127,7 @@ unordered_dense_map<Key, Value, Hash>::erase(const Key &key)
             if (entries_[entry_index].key == key)
             {
                 // Found the key to delete
-
-                // Move the last entry to this position to maintain dense packing
-                if (entry_index != size_ - 1)
-                {
-                    // Move the last entry to fill the gap
-                    entries_[entry_index] = std::move(entries_[size_ - 1]);
-
-                    // Find the bucket that points to the last entry and update its index
-                    for (size_t i = 0; i < capacity_; ++i)
-                    {
-                        if (buckets_[i].is_occupied() && buckets_[i].entry_index == size_ - 1)
-                        {
-                            buckets_[i].entry_index = entry_index;
-                            break;
-                        }
-                    }
-                }
-
-                // Use tombstone instead of backward-shift for now
-                bucket.set_tombstone();
-
-                // Remove the last entry (which is now either the deleted entry or empty after move)
-                entries_.pop_back();
-                --size_;
-
+                remove_entry(bucket, entry_index);
                 return 1;
             }
         }
@@ -189,30 +139,61 @@ unordered_dense_map<Key, Value, Hash>::erase(const Key &key)
     return 0; // Key not found
 }
 
-template <typename Key, typename Value, typename Hash>
-typename unordered_dense_map<Key, Value, Hash>::iterator
-unordered_dense_map<Key, Value, Hash>::find(const Key &key)
+template <typename Key, typename Value, typename Hash, typename Storage>
+void unordered_dense_map<Key, Value, Hash, Storage>::erase_at(size_type index)
 {
-    uint64_t hash = Hash::hash(key);
-    uint8_t fingerprint = Hash::fingerprint(key);
+    if (index >= size_)
+        throw std::out_of_range("Entry index out of range");
+    remove_entry(buckets_[bucket_of_index(Hash::hash(entries_[index].key), index)], index);
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+void unordered_dense_map<Key, Value, Hash, Storage>::remove_entry(detail::Bucket &bucket, size_t entry_index)
+{
+    // Move the last entry to this position to maintain dense packing
+    const size_t last = size_ - 1;
+    if (entry_index != last)
+    {
+        // Fill the gap, then repoint the moved entry's bucket,
+        // found by probing from its key's home position
+        entries_[entry_index] = std::move(entries_[last]);
+        buckets_[bucket_of_index(Hash::hash(entries_[entry_index].key), last)].entry_index = entry_index;
+    }
+
+    // Use tombstone instead of backward-shift for now
+    bucket.set_tombstone();
 
-    if (fingerprint == 0)
+    // Remove the last entry (which is now either the deleted entry or empty after move)
+    entries_.pop_back();
+    --size_;
+
+    if (capacity_ > INITIAL_CAPACITY && size_ < capacity_ * shrink_policy_.low_water)
     {
-        hash = detail::mix_hash(hash);
-        fingerprint = Hash::fingerprint(key);
+        shrink_to_fit();
     }
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+size_t unordered_dense_map<Key, Value, Hash, Storage>::find_index(const Key &key, uint64_t hash) const
+{
+    if (use_bloom_ && !bloom_.may_contain(hash))
+    {
+        return npos;
+    }
+
+    uint8_t fingerprint = detail::fingerprint_of(hash);
 
-    size_t ideal_pos = hash % capacity_;
+    size_t ideal_pos = detail::probe_hash(hash) % capacity_;
     size_t current_pos = ideal_pos;
     size_t distance = 0;
 
     while (distance < MAX_DISTANCE)
     {
-        detail::Bucket &bucket = buckets_[current_pos];
+        const detail::Bucket &bucket = buckets_[current_pos];
 
         if (bucket.is_empty())
         {
-            return end();
+            return npos;
         }
 
         if (bucket.is_tombstone())
@@ -226,7 +207,7 @@ unordered_dense_map<Key, Value, Hash>::find(const Key &key)
         if (bucket.is_occupied() && bucket.fingerprint == fingerprint)
         {
             size_t entry_index = bucket.entry_index;
-            
+
             // Validate entry index to prevent segfaults
             if (entry_index >= entries_.size())
             {
@@ -238,7 +219,7 @@ unordered_dense_map<Key, Value, Hash>::find(const Key &key)
 
             if (entries_[entry_index].key == key)
             {
-                return iterator(this, entry_index);
+                return entry_index;
             }
         }
 
@@ -246,53 +227,561 @@ unordered_dense_map<Key, Value, Hash>::find(const Key &key)
         ++distance;
     }
 
-    return end();
+    return npos;
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+size_t unordered_dense_map<Key, Value, Hash, Storage>::bucket_of_index(uint64_t hash, size_t entry_index) const
+{
+    // The bucket is on the probe sequence from the key's home, so this is as
+    // long as a lookup rather than a scan of the whole bucket array
+    size_t pos = detail::probe_hash(hash) % capacity_;
+    while (!(buckets_[pos].is_occupied() && buckets_[pos].entry_index == entry_index))
+    {
+        pos = (pos + 1) % capacity_;
+    }
+    return pos;
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+typename unordered_dense_map<Key, Value, Hash, Storage>::iterator
+unordered_dense_map<Key, Value, Hash, Storage>::find_hashed(const Key &key, uint64_t hash)
+{
+    size_t index = find_index(key, hash);
+    return index == npos ? end() : iterator(this, index);
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+typename unordered_dense_map<Key, Value, Hash, Storage>::const_iterator
+unordered_dense_map<Key, Value, Hash, Storage>::find_hashed(const Key &key, uint64_t hash) const
+{
+    size_t index = find_index(key, hash);
+    return index == npos ? end() : const_iterator(this, index);
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+void unordered_dense_map<Key, Value, Hash, Storage>::rehash(size_t new_capacity)
+{
+    // Entries stay where they are; only the bucket index is rebuilt.
+    while (true)
+    {
+        capacity_ = new_capacity;
+        buckets_.clear();
+        buckets_.resize(capacity_);
+        if (use_bloom_)
+        {
+            bloom_.reset(bloom_blocks_for(capacity_));
+        }
+
+        bool placed_all = true;
+        for (size_t i = 0; i < size_ && placed_all; ++i)
+        {
+            const uint64_t hash = Hash::hash(entries_[i].key);
+            placed_all = insert_bucket(hash, i);
+            if (use_bloom_)
+            {
+                bloom_.insert(hash);
+            }
+        }
+
+        if (placed_all)
+        {
+            return;
+        }
+        new_capacity *= 2;
+    }
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+void unordered_dense_map<Key, Value, Hash, Storage>::reserve(size_type count)
+{
+    size_t new_capacity = capacity_;
+    while (count >= new_capacity * MAX_LOAD_FACTOR)
+    {
+        new_capacity *= 2;
+    }
+
+    if (new_capacity != capacity_)
+    {
+        rehash(new_capacity);
+    }
+    entries_.reserve(count);
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+void unordered_dense_map<Key, Value, Hash, Storage>::shrink_to_fit()
+{
+    // rehash keeps the old bucket allocation when the size shrinks
+    rehash(capacity_for(size_));
+    buckets_.shrink_to_fit();
+    entries_.shrink_to_fit();
 }
 
-template <typename Key, typename Value, typename Hash>
-typename unordered_dense_map<Key, Value, Hash>::const_iterator
-unordered_dense_map<Key, Value, Hash>::find(const Key &key) const
+template <typename Key, typename Value, typename Hash, typename Storage>
+void unordered_dense_map<Key, Value, Hash, Storage>::set_bloom_filter(bool enabled)
 {
-    auto it = const_cast<unordered_dense_map *>(this)->find(key);
-    return const_iterator(this, it.index_);
+    use_bloom_ = enabled;
+    if (enabled)
+    {
+        rebuild_bloom();
+    }
+    else
+    {
+        bloom_ = detail::blocked_bloom_filter();
+    }
 }
 
-template <typename Key, typename Value, typename Hash>
-void unordered_dense_map<Key, Value, Hash>::rehash(size_t new_capacity)
+template <typename Key, typename Value, typename Hash, typename Storage>
+void unordered_dense_map<Key, Value, Hash, Storage>::rebuild_bloom()
 {
-    std::vector<Entry> old_entries = std::move(entries_);
+    bloom_.reset(bloom_blocks_for(capacity_));
+    for (size_t i = 0; i < size_; ++i)
+    {
+        bloom_.insert(Hash::hash(entries_[i].key));
+    }
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+size_t unordered_dense_map<Key, Value, Hash, Storage>::capacity_for(size_t count) const
+{
+    size_t new_capacity = INITIAL_CAPACITY;
+    while (count >= new_capacity * MAX_LOAD_FACTOR)
+    {
+        new_capacity *= 2;
+    }
+    return new_capacity;
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+void unordered_dense_map<Key, Value, Hash, Storage>::parallel_rehash(size_type bucket_count, size_t threads)
+{
+    size_t new_capacity = capacity_for(size_);
+    while (new_capacity < bucket_count)
+    {
+        new_capacity *= 2;
+    }
+    parallel_rebuild_index(new_capacity, threads, false);
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename InputIt>
+void unordered_dense_map<Key, Value, Hash, Storage>::parallel_build(InputIt first, InputIt last, size_t threads)
+{
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    threads = detail::resolve_thread_count(threads);
     size_t old_size = size_;
 
+    if constexpr (std::is_base_of_v<std::random_access_iterator_tag, category>)
+    {
+        constexpr size_t FILL_CHUNK = 16384;
+        const size_t count = std::distance(first, last);
+        entries_.resize(old_size + count);
+        detail::parallel_for((count + FILL_CHUNK - 1) / FILL_CHUNK, threads, [&](size_t chunk)
+                             {
+            size_t begin = chunk * FILL_CHUNK;
+            size_t end = std::min(begin + FILL_CHUNK, count);
+            for (size_t i = begin; i < end; ++i)
+            {
+                const auto &kv = first[i];
+                entries_[old_size + i].key = kv.first;
+                entries_[old_size + i].value = kv.second;
+            } });
+    }
+    else
+    {
+        // A single-pass input range can only be walked once, so it is
+        // appended without counting it first
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>)
+        {
+            entries_.reserve(old_size + std::distance(first, last));
+        }
+        for (auto it = first; it != last; ++it)
+        {
+            entries_.emplace_back(it->first, it->second);
+        }
+    }
+    size_ = entries_.size();
+
+    parallel_rebuild_index(std::max(capacity_, capacity_for(size_)), threads, true);
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+void unordered_dense_map<Key, Value, Hash, Storage>::parallel_rebuild_index(size_t new_capacity, size_t threads, bool deduplicate)
+{
+    constexpr size_t HASH_CHUNK = 16384;
+    constexpr size_t MIN_RANGE_BUCKETS = 1024;
+    constexpr size_t RANGES_PER_THREAD = 4;
+
+    threads = detail::resolve_thread_count(threads);
+    const size_t n = size_;
+    const size_t mask = new_capacity - 1;
+
+    // The serial fallback below looks keys up while the filter is stale, so
+    // it is switched off here and rebuilt once the index is complete
+    const bool bloom = std::exchange(use_bloom_, false);
+    const auto &entries = entries_; // Parallel passes only read entries
+
+    // Power-of-two number of bucket ranges: enough to feed every thread, and
+    // small enough that the range being filled stays cache-resident, but wide
+    // enough that spills across a range end stay rare.
+    size_t range_count = 1;
+    while ((range_count < threads * RANGES_PER_THREAD || new_capacity / range_count > PARTITION_BUCKETS) &&
+           new_capacity / (range_count * 2) >= MIN_RANGE_BUCKETS)
+    {
+        range_count *= 2;
+    }
+    const size_t range_size = new_capacity / range_count;
+
+    // Hash every key once and count entries per (chunk, range)
+    const size_t chunk_count = std::max<size_t>(1, (n + HASH_CHUNK - 1) / HASH_CHUNK);
+    std::vector<uint64_t> hashes(n);
+    std::vector<size_t> offsets(chunk_count * range_count, 0);
+    detail::parallel_for(chunk_count, threads, [&](size_t c)
+                         {
+        size_t *histogram = &offsets[c * range_count];
+        for (size_t i = c * HASH_CHUNK; i < std::min(n, (c + 1) * HASH_CHUNK); ++i)
+        {
+            hashes[i] = Hash::hash(entries[i].key);
+            ++histogram[(detail::probe_hash(hashes[i]) & mask) / range_size];
+        } });
+
+    // Range-major prefix sums, so each range's entries are contiguous and in
+    // entry order
+    std::vector<size_t> range_begin(range_count + 1, 0);
+    size_t running = 0;
+    for (size_t r = 0; r < range_count; ++r)
+    {
+        range_begin[r] = running;
+        for (size_t c = 0; c < chunk_count; ++c)
+        {
+            size_t bucket_count = offsets[c * range_count + r];
+            offsets[c * range_count + r] = running;
+            running += bucket_count;
+        }
+    }
+    range_begin[range_count] = running;
+
+    // Hashes travel with the indices so filling a range reads them sequentially
+    struct Slot
+    {
+        uint64_t hash;
+        size_t index;
+    };
+    std::vector<Slot> order(n);
+    detail::parallel_for(chunk_count, threads, [&](size_t c)
+                         {
+        size_t *cursor = &offsets[c * range_count];
+        for (size_t i = c * HASH_CHUNK; i < std::min(n, (c + 1) * HASH_CHUNK); ++i)
+        {
+            order[cursor[(detail::probe_hash(hashes[i]) & mask) / range_size]++] = {hashes[i], i};
+        } });
+
+    // Release the hashes before the bucket array is allocated; the rare paths
+    // below that need a hash again (spills, fallback, compaction) recompute it
+    std::vector<uint64_t>().swap(hashes);
+
     capacity_ = new_capacity;
     buckets_.clear();
     buckets_.resize(capacity_);
-    entries_.clear();
-    size_ = 0;
 
-    // Reinsert all entries
-    for (size_t i = 0; i < old_size; ++i)
+    // Each range is written by exactly one task. Robin-hood probing stops at
+    // the range end; whatever would cross it is queued for the serial pass.
+    std::vector<uint8_t> dropped(deduplicate ? n : 0, 0);
+    std::vector<std::vector<Slot>> spilled(range_count);
+    detail::parallel_for(range_count, threads, [&](size_t r)
+                         {
+        const size_t range_end = (r + 1) * range_size;
+        for (size_t k = range_begin[r]; k < range_begin[r + 1]; ++k)
+        {
+            const size_t idx = order[k].index;
+            const uint64_t hash = order[k].hash;
+            detail::Bucket pending;
+            pending.set_occupied(detail::fingerprint_of(hash), 0, idx);
+            size_t pos = detail::probe_hash(hash) & mask;
+            size_t distance = 0;
+            bool original = true;
+
+            while (true)
+            {
+                if (pos >= range_end || distance >= MAX_DISTANCE)
+                {
+                    const size_t spill = pending.entry_index;
+                    spilled[r].push_back({original ? hash : Hash::hash(entries[spill].key), spill});
+                    break;
+                }
+
+                detail::Bucket &bucket = buckets_[pos];
+                if (bucket.is_empty())
+                {
+                    pending.distance = distance;
+                    bucket = pending;
+                    break;
+                }
+
+                // Entries are visited in index order, so an existing match
+                // is always the earlier occurrence
+                if (deduplicate && original && bucket.fingerprint == pending.fingerprint &&
+                    entries[bucket.entry_index].key == entries[idx].key)
+                {
+                    dropped[idx] = 1;
+                    break;
+                }
+
+                if (bucket.distance < distance)
+                {
+                    pending.distance = distance;
+                    distance = bucket.distance;
+                    std::swap(bucket, pending);
+                    original = false;
+                }
+
+                ++pos;
+                ++distance;
+            }
+        } });
+
+    // Serial pass for the spills, which may wrap around the table
+    bool complete = true;
+    for (const auto &range_spills : spilled)
+    {
+        for (const auto [hash, idx] : range_spills)
+        {
+            if (deduplicate)
+            {
+                size_t pos = detail::probe_hash(hash) & mask;
+                bool duplicate = false;
+                for (size_t distance = 0; distance < MAX_DISTANCE && !buckets_[pos].is_empty(); ++distance)
+                {
+                    detail::Bucket &bucket = buckets_[pos];
+                    if (bucket.fingerprint == detail::fingerprint_of(hash) &&
+                        entries_[bucket.entry_index].key == entries_[idx].key)
+                    {
+                        // Keep whichever occurrence came first
+                        if (bucket.entry_index > idx)
+                        {
+                            dropped[bucket.entry_index] = 1;
+                            bucket.entry_index = idx;
+                        }
+                        else
+                        {
+                            dropped[idx] = 1;
+                        }
+                        duplicate = true;
+                        break;
+                    }
+                    pos = (pos + 1) & mask;
+                }
+                if (duplicate)
+                {
+                    continue;
+                }
+            }
+            complete &= insert_bucket(hash, idx);
+        }
+    }
+
+    if (!complete && deduplicate)
     {
-        emplace(std::move(old_entries[i].key), std::move(old_entries[i].value));
+        // A probe sequence overflowed, so some entries have no bucket and
+        // duplicates of them went unnoticed. Redo the index serially.
+        capacity_ *= 2;
+        buckets_.clear();
+        buckets_.resize(capacity_);
+        std::fill(dropped.begin(), dropped.end(), 0);
+        for (size_t i = 0; i < n; ++i)
+        {
+            const uint64_t hash = Hash::hash(entries_[i].key);
+            if (find_index(entries_[i].key, hash) != npos)
+            {
+                dropped[i] = 1;
+            }
+            else
+            {
+                complete &= insert_bucket(hash, i);
+            }
+        }
+    }
+
+    // Fill each dropped duplicate's slot with the last live entry, as erase
+    // does, so only the moved entries need their bucket repointed
+    if (deduplicate)
+    {
+        size_t live_end = n;
+        for (size_t hole = 0; hole < live_end; ++hole)
+        {
+            if (!dropped[hole])
+            {
+                continue;
+            }
+            while (live_end > hole + 1 && dropped[live_end - 1])
+            {
+                --live_end;
+            }
+            if (live_end == hole + 1)
+            {
+                live_end = hole;
+                break;
+            }
+
+            const size_t moved = --live_end;
+            entries_[hole] = std::move(entries_[moved]);
+            if (complete)
+            {
+                size_t pos = detail::probe_hash(Hash::hash(entries_[hole].key)) & mask;
+                while (!(buckets_[pos].is_occupied() && buckets_[pos].entry_index == moved))
+                {
+                    pos = (pos + 1) & mask;
+                }
+                buckets_[pos].entry_index = hole;
+            }
+        }
+        while (entries_.size() > live_end)
+        {
+            entries_.pop_back();
+        }
+        size_ = live_end;
+    }
+
+    if (!complete)
+    {
+        rehash(capacity_ * 2);
+    }
+
+    if (bloom)
+    {
+        use_bloom_ = true;
+        rebuild_bloom();
     }
 }
 
-// Batch operations implementation
-template <typename Key, typename Value, typename Hash>
-template <typename InputIt>
-void unordered_dense_map<Key, Value, Hash>::batch_insert(InputIt first, InputIt last)
+// Whole-map algorithms
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename Policy, typename F>
+void unordered_dense_map<Key, Value, Hash, Storage>::for_each_chunk(const Policy &policy, F &&f) const
 {
-    size_t count = std::distance(first, last);
+    const size_t chunks = (size_ + ALGORITHM_CHUNK - 1) / ALGORITHM_CHUNK;
+    detail::parallel_for(chunks, detail::policy_thread_count(policy), [&](size_t chunk)
+                         {
+        size_t begin = chunk * ALGORITHM_CHUNK;
+        f(chunk, begin, std::min(begin + ALGORITHM_CHUNK, size_)); });
+}
 
-    // Reserve space to minimize reallocations
-    if (size_ + count >= capacity_ * MAX_LOAD_FACTOR)
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename F>
+void unordered_dense_map<Key, Value, Hash, Storage>::for_each(F f)
+{
+    for_each(dense_execution::seq, std::move(f));
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <detail::execution_policy Policy, typename F>
+void unordered_dense_map<Key, Value, Hash, Storage>::for_each(const Policy &policy, F f)
+{
+    detach_entries();
+    auto &entries = entries_;
+    for_each_chunk(policy, [&](size_t, size_t begin, size_t end)
+                   {
+        for (size_t i = begin; i < end; ++i)
+        {
+            f(std::as_const(entries[i].key), entries[i].value);
+        } });
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename F>
+void unordered_dense_map<Key, Value, Hash, Storage>::transform_values(F f)
+{
+    transform_values(dense_execution::seq, std::move(f));
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <detail::execution_policy Policy, typename F>
+void unordered_dense_map<Key, Value, Hash, Storage>::transform_values(const Policy &policy, F f)
+{
+    detach_entries();
+    auto &entries = entries_;
+    for_each_chunk(policy, [&](size_t, size_t begin, size_t end)
+                   {
+        for (size_t i = begin; i < end; ++i)
+        {
+            entries[i].value = f(std::as_const(entries[i].value));
+        } });
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename Pred>
+typename unordered_dense_map<Key, Value, Hash, Storage>::size_type
+unordered_dense_map<Key, Value, Hash, Storage>::count_if(Pred pred) const
+{
+    return count_if(dense_execution::seq, std::move(pred));
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <detail::execution_policy Policy, typename Pred>
+typename unordered_dense_map<Key, Value, Hash, Storage>::size_type
+unordered_dense_map<Key, Value, Hash, Storage>::count_if(const Policy &policy, Pred pred) const
+{
+    const size_t chunks = (size_ + ALGORITHM_CHUNK - 1) / ALGORITHM_CHUNK;
+    std::vector<size_type> counts(chunks, 0);
+    const auto &entries = entries_;
+    for_each_chunk(policy, [&](size_t chunk, size_t begin, size_t end)
+                   {
+        size_type count = 0;
+        for (size_t i = begin; i < end; ++i)
+        {
+            count += pred(entries[i].key, entries[i].value) ? 1 : 0;
+        }
+        counts[chunk] = count; });
+
+    size_type total = 0;
+    for (size_type count : counts)
     {
-        size_t new_capacity = capacity_;
-        while (size_ + count >= new_capacity * MAX_LOAD_FACTOR)
+        total += count;
+    }
+    return total;
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename T, typename Combine, typename Proj>
+T unordered_dense_map<Key, Value, Hash, Storage>::reduce(T init, Combine combine, Proj proj) const
+{
+    return reduce(dense_execution::seq, std::move(init), std::move(combine), std::move(proj));
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <detail::execution_policy Policy, typename T, typename Combine, typename Proj>
+T unordered_dense_map<Key, Value, Hash, Storage>::reduce(const Policy &policy, T init, Combine combine, Proj proj) const
+{
+    // Chunk partials are folded in chunk order, so the result does not depend
+    // on the thread count
+    const size_t chunks = (size_ + ALGORITHM_CHUNK - 1) / ALGORITHM_CHUNK;
+    std::vector<std::optional<T>> partials(chunks);
+    const auto &entries = entries_;
+    for_each_chunk(policy, [&](size_t chunk, size_t begin, size_t end)
+                   {
+        T acc = proj(entries[begin].key, entries[begin].value);
+        for (size_t i = begin + 1; i < end; ++i)
         {
-            new_capacity *= 2;
+            acc = combine(std::move(acc), proj(entries[i].key, entries[i].value));
         }
-        rehash(new_capacity);
+        partials[chunk].emplace(std::move(acc)); });
+
+    for (auto &partial : partials)
+    {
+        init = combine(std::move(init), std::move(*partial));
     }
+    return init;
+}
+
+// Batch operations implementation
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename InputIt>
+void unordered_dense_map<Key, Value, Hash, Storage>::batch_insert(InputIt first, InputIt last)
+{
+    size_t count = std::distance(first, last);
+
+    // Reserve space to minimize reallocations
+    reserve(size_ + count);
 
     // For small batches or non-integer keys, use regular insertion
     if (!std::is_same_v<Key, int>)
@@ -340,30 +829,383 @@ void unordered_dense_map<Key, Value, Hash>::batch_insert(InputIt first, InputIt
     }
 }
 
-template <typename Key, typename Value, typename Hash>
+template <typename Key, typename Value, typename Hash, typename Storage>
 template <typename InputIt, typename OutputIt>
-void unordered_dense_map<Key, Value, Hash>::batch_find(InputIt keys_first, InputIt keys_last, OutputIt results_first)
+void unordered_dense_map<Key, Value, Hash, Storage>::batch_find(InputIt keys_first, InputIt keys_last, OutputIt results_first)
 {
-    // For now, implement using regular find
-    // TODO: Add SIMD optimization for probe sequence
-    for (auto it = keys_first; it != keys_last; ++it, ++results_first)
+    lookup_range(keys_first, keys_last, [&](size_t, size_t index)
+                 {
+        *results_first = index == npos ? end() : iterator(this, index);
+        ++results_first; });
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename InputIt>
+std::vector<bool> unordered_dense_map<Key, Value, Hash, Storage>::batch_contains(InputIt first, InputIt last)
+{
+    std::vector<bool> results(std::distance(first, last));
+    batch_lookup(first, last, [&](size_t i, const Entry *entry)
+                 { results[i] = entry != nullptr; });
+    return results;
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename KeyAt, typename F>
+void unordered_dense_map<Key, Value, Hash, Storage>::lookup_pipeline(size_t count, KeyAt &&key_at, F &&f, size_t block_size) const
+{
+    uint64_t local_hashes[LOOKUP_BLOCK];
+    std::vector<uint64_t> heap_hashes;
+    block_size = std::max<size_t>(1, block_size);
+    if (block_size > LOOKUP_BLOCK)
+    {
+        heap_hashes.resize(std::min(block_size, count));
+    }
+    uint64_t *hashes = heap_hashes.empty() ? local_hashes : heap_hashes.data();
+    block_size = heap_hashes.empty() ? std::min(block_size, LOOKUP_BLOCK) : heap_hashes.size();
+
+    for (size_t block = 0; block < count; block += block_size)
     {
-        *results_first = find(*it);
+        const size_t n = std::min(block_size, count - block);
+
+        // Stage 1: hash and prefetch the home buckets, or the filter blocks
+        // when there is a Bloom filter
+        for (size_t j = 0; j < n; ++j)
+        {
+            hashes[j] = Hash::hash(key_at(block + j));
+            detail::prefetch(use_bloom_ ? bloom_.block_address(hashes[j])
+                                        : &buckets_[detail::probe_hash(hashes[j]) % capacity_]);
+        }
+
+        // Stage 2: prefetch the entry a matching home bucket points at, or
+        // the home bucket of a key that passed the filter
+        for (size_t j = 0; j < n; ++j)
+        {
+            if (use_bloom_)
+            {
+                if (bloom_.may_contain(hashes[j]))
+                {
+                    detail::prefetch(&buckets_[detail::probe_hash(hashes[j]) % capacity_]);
+                }
+                continue;
+            }
+            const detail::Bucket &home = buckets_[detail::probe_hash(hashes[j]) % capacity_];
+            if (home.is_occupied() && home.fingerprint == detail::fingerprint_of(hashes[j]))
+            {
+                detail::prefetch(&entries_[home.entry_index]);
+            }
+        }
+
+        // Stage 3: probe, by now mostly from cache
+        for (size_t j = 0; j < n; ++j)
+        {
+            f(block + j, hashes[j], find_index(key_at(block + j), hashes[j]));
+        }
     }
 }
 
-template <typename Key, typename Value, typename Hash>
-template <typename InputIt>
-std::vector<bool> unordered_dense_map<Key, Value, Hash>::batch_contains(InputIt first, InputIt last)
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename ForwardIt, typename F>
+void unordered_dense_map<Key, Value, Hash, Storage>::batch_lookup(ForwardIt first, ForwardIt last, F f) const
 {
-    size_t count = std::distance(first, last);
-    std::vector<bool> results;
-    results.reserve(count);
+    lookup_range(first, last, [&](size_t position, size_t index)
+                 { f(position, index == npos ? nullptr : &entries_[index]); });
+}
 
-    for (auto it = first; it != last; ++it)
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename ForwardIt, typename F>
+void unordered_dense_map<Key, Value, Hash, Storage>::lookup_range(ForwardIt first, ForwardIt last, F &&f) const
+{
+    const Key *block_keys[LOOKUP_BLOCK];
+    size_t position = 0;
+
+    while (first != last)
     {
-        results.push_back(contains(*it));
+        size_t n = 0;
+        for (; n < LOOKUP_BLOCK && first != last; ++n, ++first)
+        {
+            block_keys[n] = std::addressof(*first);
+        }
+
+        lookup_pipeline(n, [&](size_t j) -> const Key &
+                        { return *block_keys[j]; },
+                        [&](size_t j, uint64_t, size_t index)
+                        { f(position + j, index); });
+        position += n;
     }
+}
 
-    return results;
-}
\ No newline at end of file
+// Columnar aggregation
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <std::ranges::contiguous_range Values, typename Op>
+void unordered_dense_map<Key, Value, Hash, Storage>::aggregate(std::span<const Key> keys, const Values &values, Op op,
+                                                      size_t block_size)
+{
+    if (std::ranges::size(values) != keys.size())
+    {
+        throw std::invalid_argument("aggregate: key and value columns differ in length");
+    }
+    auto *data = std::ranges::data(values);
+    aggregate_rows(keys, [data](size_t i) -> const auto &
+                   { return data[i]; },
+                   op, block_size);
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename Op>
+void unordered_dense_map<Key, Value, Hash, Storage>::aggregate(std::span<const Key> keys, Op op, size_t block_size)
+{
+    aggregate_rows(keys, [keys](size_t i) -> const Key &
+                   { return keys[i]; },
+                   op, block_size);
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename ValueAt, typename Op>
+void unordered_dense_map<Key, Value, Hash, Storage>::aggregate_rows(std::span<const Key> keys, ValueAt &&value_at, Op &op,
+                                                           size_t block_size)
+{
+    lookup_pipeline(keys.size(), [keys](size_t i) -> const Key &
+                    { return keys[i]; },
+                    [&](size_t i, uint64_t hash, size_t index)
+                    {
+        const auto &x = value_at(i);
+        if (index != npos)
+        {
+            op(entries_[index].value, x);
+        }
+        else if constexpr (requires { op.init(x); })
+        {
+            emplace_unique(keys[i], hash, static_cast<Value>(op.init(x)));
+        }
+        else
+        {
+            auto [it, inserted] = emplace_unique(keys[i], hash);
+            op(it->value, x);
+        } },
+                    block_size);
+}
+
+// Sorted export
+template <typename Key, typename Value, typename Hash, typename Storage>
+std::vector<size_t> unordered_dense_map<Key, Value, Hash, Storage>::sorted_order() const
+{
+    if constexpr (detail::radix_sortable<Key>)
+    {
+        return detail::radix_sorted_order<Key>(size_, [this](size_t i)
+                                               { return entries_[i].key; });
+    }
+    else
+    {
+        std::vector<size_t> order(size_);
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::sort(order.begin(), order.end(), [this](size_t a, size_t b)
+                  { return entries_[a].key < entries_[b].key; });
+        return order;
+    }
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+std::vector<std::pair<Key, Value>> unordered_dense_map<Key, Value, Hash, Storage>::export_sorted() const
+{
+    std::vector<std::pair<Key, Value>> out;
+    out.reserve(size_);
+    for (size_t index : sorted_order())
+    {
+        out.emplace_back(entries_[index].key, entries_[index].value);
+    }
+    return out;
+}
+
+// Set algebra
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename Policy>
+std::vector<typename unordered_dense_map<Key, Value, Hash, Storage>::ProbeHit>
+unordered_dense_map<Key, Value, Hash, Storage>::probe_entries_of(const Policy &policy, const unordered_dense_map &source, bool present) const
+{
+    const size_t chunks = (source.size_ + ALGORITHM_CHUNK - 1) / ALGORITHM_CHUNK;
+    std::vector<std::vector<ProbeHit>> per_chunk(chunks);
+
+    source.for_each_chunk(policy, [&](size_t chunk, size_t begin, size_t end)
+                          {
+        auto &out = per_chunk[chunk];
+        lookup_pipeline(end - begin, [&](size_t j) -> const Key &
+                        { return source.entries_[begin + j].key; },
+                        [&](size_t j, uint64_t hash, size_t index)
+                        {
+            if ((index != npos) == present)
+            {
+                out.push_back({begin + j, index, hash});
+            } }); });
+
+    std::vector<ProbeHit> hits;
+    size_t total = 0;
+    for (const auto &out : per_chunk)
+    {
+        total += out.size();
+    }
+    hits.reserve(total);
+    for (const auto &out : per_chunk)
+    {
+        hits.insert(hits.end(), out.begin(), out.end());
+    }
+    return hits;
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+unordered_dense_map<Key, Value, Hash, Storage> unordered_dense_map<Key, Value, Hash, Storage>::intersect(const unordered_dense_map &other) const
+{
+    return intersect(dense_execution::seq, other);
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <detail::execution_policy Policy>
+unordered_dense_map<Key, Value, Hash, Storage>
+unordered_dense_map<Key, Value, Hash, Storage>::intersect(const Policy &policy, const unordered_dense_map &other) const
+{
+    const bool walk_this = size_ <= other.size_;
+    std::vector<ProbeHit> hits = walk_this ? other.probe_entries_of(policy, *this, true)
+                                           : probe_entries_of(policy, other, true);
+
+    unordered_dense_map result;
+    result.reserve(hits.size());
+    for (const ProbeHit &hit : hits)
+    {
+        const Entry &entry = entries_[walk_this ? hit.source_index : hit.found_index];
+        result.try_emplace_hashed(entry.key, hit.hash, entry.value);
+    }
+    return result;
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+unordered_dense_map<Key, Value, Hash, Storage> unordered_dense_map<Key, Value, Hash, Storage>::difference(const unordered_dense_map &other) const
+{
+    return difference(dense_execution::seq, other);
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <detail::execution_policy Policy>
+unordered_dense_map<Key, Value, Hash, Storage>
+unordered_dense_map<Key, Value, Hash, Storage>::difference(const Policy &policy, const unordered_dense_map &other) const
+{
+    unordered_dense_map result;
+
+    if (size_ <= other.size_)
+    {
+        std::vector<ProbeHit> misses = other.probe_entries_of(policy, *this, false);
+        result.reserve(misses.size());
+        for (const ProbeHit &miss : misses)
+        {
+            const Entry &entry = entries_[miss.source_index];
+            result.try_emplace_hashed(entry.key, miss.hash, entry.value);
+        }
+        return result;
+    }
+
+    // other is smaller: walk it to strike out shared keys, then copy the rest
+    std::vector<ProbeHit> shared = probe_entries_of(policy, other, true);
+    std::vector<uint8_t> drop(size_, 0);
+    for (const ProbeHit &hit : shared)
+    {
+        drop[hit.found_index] = 1;
+    }
+
+    result.reserve(size_ - shared.size());
+    for (size_t i = 0; i < size_; ++i)
+    {
+        if (!drop[i])
+        {
+            result.try_emplace(entries_[i].key, entries_[i].value);
+        }
+    }
+    return result;
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+unordered_dense_map<Key, Value, Hash, Storage>
+unordered_dense_map<Key, Value, Hash, Storage>::symmetric_difference(const unordered_dense_map &other) const
+{
+    return symmetric_difference(dense_execution::seq, other);
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <detail::execution_policy Policy>
+unordered_dense_map<Key, Value, Hash, Storage>
+unordered_dense_map<Key, Value, Hash, Storage>::symmetric_difference(const Policy &policy, const unordered_dense_map &other) const
+{
+    std::vector<ProbeHit> only_this = other.probe_entries_of(policy, *this, false);
+    std::vector<ProbeHit> only_other = probe_entries_of(policy, other, false);
+
+    unordered_dense_map result;
+    result.reserve(only_this.size() + only_other.size());
+    for (const ProbeHit &miss : only_this)
+    {
+        const Entry &entry = entries_[miss.source_index];
+        result.try_emplace_hashed(entry.key, miss.hash, entry.value);
+    }
+    for (const ProbeHit &miss : only_other)
+    {
+        const Entry &entry = other.entries_[miss.source_index];
+        result.try_emplace_hashed(entry.key, miss.hash, entry.value);
+    }
+    return result;
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <typename Combine>
+void unordered_dense_map<Key, Value, Hash, Storage>::union_with(const unordered_dense_map &other, Combine combine)
+{
+    union_with(dense_execution::seq, other, std::move(combine));
+}
+
+template <typename Key, typename Value, typename Hash, typename Storage>
+template <detail::execution_policy Policy, typename Combine>
+void unordered_dense_map<Key, Value, Hash, Storage>::union_with(const Policy &policy, const unordered_dense_map &other, Combine combine)
+{
+    if (&other == this)
+    {
+        if constexpr (!std::is_same_v<Combine, detail::keep_existing>)
+        {
+            transform_values(policy, [&](const Value &v)
+                             { return combine(v, v); });
+        }
+        return;
+    }
+
+    // Shared keys hit distinct entries, so they can be combined inside the
+    // parallel probe; new keys are appended afterwards.
+    if constexpr (!std::is_same_v<Combine, detail::keep_existing>)
+    {
+        detach_entries();
+    }
+    const size_t chunks = (other.size_ + ALGORITHM_CHUNK - 1) / ALGORITHM_CHUNK;
+    std::vector<std::vector<ProbeHit>> per_chunk(chunks);
+    other.for_each_chunk(policy, [&](size_t chunk, size_t begin, size_t end)
+                         {
+        lookup_pipeline(end - begin, [&](size_t j) -> const Key &
+                        { return other.entries_[begin + j].key; },
+                        [&](size_t j, uint64_t hash, size_t index)
+                        {
+            if (index == npos)
+            {
+                per_chunk[chunk].push_back({begin + j, npos, hash});
+            }
+            else if constexpr (!std::is_same_v<Combine, detail::keep_existing>)
+            {
+                entries_[index].value = combine(entries_[index].value, other.entries_[begin + j].value);
+            } }); });
+
+    size_t added = 0;
+    for (const auto &misses : per_chunk)
+    {
+        added += misses.size();
+    }
+    reserve(size_ + added);
+    for (const auto &misses : per_chunk)
+    {
+        for (const ProbeHit &miss : misses)
+        {
+            const Entry &entry = other.entries_[miss.source_index];
+            try_emplace_hashed(entry.key, miss.hash, entry.value);
+        }
+    }
+}
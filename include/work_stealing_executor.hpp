@@ -0,0 +1,416 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dense_execution
+{
+    // Scheduler interface behind every parallel operation in the library.
+    // bulk(tasks, max_parallelism, f) runs f(i) for each i in [0, tasks) on
+    // at most max_parallelism threads (0 = no limit), blocks until all of
+    // them have finished and rethrows the first exception a task threw. The
+    // calling thread is expected to take part.
+    class executor
+    {
+    public:
+        virtual ~executor() = default;
+
+        virtual size_t concurrency() const = 0;
+        virtual void bulk(size_t tasks, size_t max_parallelism, const std::function<void(size_t)> &f) = 0;
+    };
+}
+
+namespace detail
+{
+    // Chase-Lev work-stealing deque (Le et al., "Correct and Efficient
+    // Work-Stealing for Weak Memory Models"). The owner pushes and pops at the
+    // bottom; thieves take from the top. Slots are atomics with release /
+    // acquire ordering so the published item is visible without relying on
+    // the fences alone. Replaced rings stay alive until the deque dies, since
+    // a thief may still be reading one.
+    template <typename T>
+    class chase_lev_deque
+    {
+    public:
+        explicit chase_lev_deque(size_t capacity = 64)
+        {
+            rings_.push_back(std::make_unique<Ring>(capacity));
+            ring_.store(rings_.back().get(), std::memory_order_relaxed);
+        }
+
+        // Owner only.
+        void push(T item)
+        {
+            int64_t b = bottom_.load(std::memory_order_relaxed);
+            int64_t t = top_.load(std::memory_order_acquire);
+            Ring *ring = ring_.load(std::memory_order_relaxed);
+            if (b - t > static_cast<int64_t>(ring->mask))
+            {
+                ring = grow(ring, t, b);
+            }
+            ring->put(b, item);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+
+        // Owner only.
+        bool pop(T &out)
+        {
+            int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+            Ring *ring = ring_.load(std::memory_order_relaxed);
+            bottom_.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top_.load(std::memory_order_relaxed);
+
+            if (t > b)
+            {
+                bottom_.store(b + 1, std::memory_order_relaxed);
+                return false; // Empty
+            }
+
+            out = ring->get(b);
+            if (t == b)
+            {
+                // Last item: race the thieves for it
+                bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                        std::memory_order_relaxed);
+                bottom_.store(b + 1, std::memory_order_relaxed);
+                return won;
+            }
+            return true;
+        }
+
+        // Any thread.
+        bool steal(T &out)
+        {
+            int64_t t = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = bottom_.load(std::memory_order_acquire);
+            if (t >= b)
+            {
+                return false;
+            }
+
+            Ring *ring = ring_.load(std::memory_order_acquire);
+            out = ring->get(t);
+            return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                std::memory_order_relaxed);
+        }
+
+    private:
+        struct Ring
+        {
+            explicit Ring(size_t capacity) : mask(capacity - 1), slots(new std::atomic<T>[capacity]) {}
+
+            T get(int64_t i) const { return slots[i & mask].load(std::memory_order_acquire); }
+            void put(int64_t i, T item) { slots[i & mask].store(item, std::memory_order_release); }
+
+            size_t mask;
+            std::unique_ptr<std::atomic<T>[]> slots;
+        };
+
+        Ring *grow(Ring *old, int64_t top, int64_t bottom)
+        {
+            rings_.push_back(std::make_unique<Ring>((old->mask + 1) * 2));
+            Ring *ring = rings_.back().get();
+            for (int64_t i = top; i < bottom; ++i)
+            {
+                ring->put(i, old->get(i));
+            }
+            ring_.store(ring, std::memory_order_release);
+            return ring;
+        }
+
+        alignas(64) std::atomic<int64_t> top_{0};
+        alignas(64) std::atomic<int64_t> bottom_{0};
+        std::atomic<Ring *> ring_{nullptr};
+        std::vector<std::unique_ptr<Ring>> rings_; // Owner only
+    };
+}
+
+// Fixed pool of workers, each owning a Chase-Lev deque. A bulk call publishes
+// one runner token per extra thread it wants; whoever picks a token up claims
+// task indices from the call's shared counter until none are left, so load
+// balances dynamically while each steal moves a whole runner. Calls made from
+// a worker (nested parallelism) push onto that worker's deque; calls from other
+// threads go through a small injection queue. A waiting caller keeps executing
+// queued tokens, so nested calls cannot deadlock the pool.
+class work_stealing_executor : public dense_execution::executor
+{
+public:
+    // The caller of bulk() counts as one of `threads`, so threads - 1 workers
+    // are started. 0 means hardware_concurrency.
+    explicit work_stealing_executor(size_t threads = 0)
+    {
+        if (threads == 0)
+        {
+            threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        concurrency_ = threads;
+
+        workers_.reserve(threads - 1);
+        for (size_t i = 0; i + 1 < threads; ++i)
+        {
+            workers_.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < workers_.size(); ++i)
+        {
+            workers_[i]->thread = std::thread([this, i]()
+                                              { run_worker(i); });
+        }
+    }
+
+    ~work_stealing_executor() override
+    {
+        stop_.store(true, std::memory_order_release);
+        epoch_.fetch_add(1, std::memory_order_release);
+        epoch_.notify_all();
+        for (auto &worker : workers_)
+        {
+            worker->thread.join();
+        }
+    }
+
+    work_stealing_executor(const work_stealing_executor &) = delete;
+    work_stealing_executor &operator=(const work_stealing_executor &) = delete;
+
+    size_t concurrency() const override { return concurrency_; }
+
+    void bulk(size_t tasks, size_t max_parallelism, const std::function<void(size_t)> &f) override
+    {
+        size_t parallelism = std::min(concurrency_, tasks);
+        if (max_parallelism != 0)
+        {
+            parallelism = std::min(parallelism, max_parallelism);
+        }
+
+        if (parallelism <= 1)
+        {
+            for (size_t task = 0; task < tasks; ++task)
+            {
+                f(task);
+            }
+            return;
+        }
+
+        Job job(tasks, f);
+        const size_t tokens = parallelism - 1;
+        job.active.store(tokens, std::memory_order_relaxed);
+
+        const size_t self = current_worker();
+        if (self != NOT_A_WORKER)
+        {
+            for (size_t i = 0; i < tokens; ++i)
+            {
+                workers_[self]->deque.push(&job);
+            }
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(injection_mutex_);
+            injection_.insert(injection_.end(), tokens, &job);
+        }
+        epoch_.fetch_add(1, std::memory_order_release);
+        epoch_.notify_all();
+
+        job.run();
+
+        // Help with whatever is queued until every token has been retired
+        while (job.active.load(std::memory_order_acquire) != 0)
+        {
+            if (!run_one(self))
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        if (job.error)
+        {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+private:
+    static constexpr size_t NOT_A_WORKER = SIZE_MAX;
+    static constexpr int SPIN_ROUNDS = 64;
+
+    struct Job
+    {
+        Job(size_t tasks, const std::function<void(size_t)> &f) : tasks(tasks), f(f) {}
+
+        void run()
+        {
+            size_t task;
+            while ((task = next.fetch_add(1, std::memory_order_relaxed)) < tasks)
+            {
+                try
+                {
+                    f(task);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                    next.store(tasks, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Runs a token; must be the token's last touch of the job, since the
+        // owning bulk() call may return as soon as active reaches zero.
+        void run_token()
+        {
+            run();
+            active.fetch_sub(1, std::memory_order_acq_rel);
+        }
+
+        const size_t tasks;
+        const std::function<void(size_t)> &f;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> active{0};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+    };
+
+    struct Worker
+    {
+        detail::chase_lev_deque<Job *> deque;
+        std::thread thread;
+    };
+
+    struct WorkerSlot
+    {
+        const work_stealing_executor *owner = nullptr;
+        size_t index = 0;
+    };
+
+    static WorkerSlot &this_thread_slot()
+    {
+        thread_local WorkerSlot slot;
+        return slot;
+    }
+
+    size_t current_worker() const
+    {
+        const WorkerSlot &slot = this_thread_slot();
+        return slot.owner == this ? slot.index : NOT_A_WORKER;
+    }
+
+    bool pop_injected(Job *&job)
+    {
+        std::lock_guard<std::mutex> lock(injection_mutex_);
+        if (injection_.empty())
+        {
+            return false;
+        }
+        job = injection_.back();
+        injection_.pop_back();
+        return true;
+    }
+
+    bool steal_any(size_t self, Job *&job)
+    {
+        thread_local uint64_t rng = 0x9E3779B97F4A7C15ull ^ reinterpret_cast<uintptr_t>(&rng);
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+
+        const size_t n = workers_.size();
+        const size_t start = n ? rng % n : 0;
+        for (size_t k = 0; k < n; ++k)
+        {
+            size_t victim = (start + k) % n;
+            if (victim != self && workers_[victim]->deque.steal(job))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Own deque first, then the injection queue, then a random victim.
+    bool run_one(size_t self)
+    {
+        Job *job = nullptr;
+        bool found = (self != NOT_A_WORKER && workers_[self]->deque.pop(job)) ||
+                     pop_injected(job) || steal_any(self, job);
+        if (found)
+        {
+            job->run_token();
+        }
+        return found;
+    }
+
+    void run_worker(size_t index)
+    {
+        this_thread_slot() = {this, index};
+
+        while (!stop_.load(std::memory_order_acquire))
+        {
+            uint64_t seen = epoch_.load(std::memory_order_acquire);
+
+            bool worked = false;
+            for (int spin = 0; spin < SPIN_ROUNDS && !worked; ++spin)
+            {
+                worked = run_one(index);
+            }
+            if (worked || stop_.load(std::memory_order_acquire))
+            {
+                continue;
+            }
+
+            epoch_.wait(seen, std::memory_order_acquire);
+        }
+    }
+
+    size_t concurrency_ = 1;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::mutex injection_mutex_;
+    std::vector<Job *> injection_;
+    std::atomic<uint64_t> epoch_{0};
+    std::atomic<bool> stop_{false};
+};
+
+namespace detail
+{
+    inline std::atomic<dense_execution::executor *> &installed_executor()
+    {
+        static std::atomic<dense_execution::executor *> installed{nullptr};
+        return installed;
+    }
+}
+
+namespace dense_execution
+{
+    // The executor used by the library's parallel operations. Unless
+    // replaced, a work_stealing_executor with one thread per core is created
+    // on first use.
+    inline executor &default_executor()
+    {
+        if (executor *installed = detail::installed_executor().load(std::memory_order_acquire))
+        {
+            return *installed;
+        }
+        static work_stealing_executor builtin;
+        return builtin;
+    }
+
+    // Routes library parallelism through `exec` (e.g. an adapter over an
+    // existing scheduler); nullptr restores the built-in pool. The executor
+    // must outlive every parallel call that may use it. Not meant to be
+    // switched while parallel operations are running.
+    inline void set_default_executor(executor *exec)
+    {
+        detail::installed_executor().store(exec, std::memory_order_release);
+    }
+}
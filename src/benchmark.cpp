@@ -1,6 +1,17 @@
 #include "../include/unordered_dense_map.hpp"
 #include "../include/unordered_dense_map_impl.hpp"
 #include "../include/concurrent_unordered_dense_map.hpp"
+#include "../include/work_stealing_executor.hpp"
+#include "../include/hash_join.hpp"
+#include "../include/flat_dense_map.hpp"
+#include "../include/split_dense_map.hpp"
+#include "../include/spilling_dense_map.hpp"
+#include "../include/durable_dense_map.hpp"
+#include "../include/constexpr_dense_map.hpp"
+#include "../include/static_dense_map.hpp"
+#include "../include/slot_dense_map.hpp"
+#include "../include/cuckoo_filter.hpp"
+#include "../include/cuckoo_dense_map.hpp"
 #include <unordered_map>
 #include <chrono>
 #include <iostream>
@@ -10,9 +21,50 @@
 #include <thread>
 #include <numeric>
 #include <cmath>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <unistd.h>
 
 using namespace std::chrono;
 
+// Counts heap bytes in use so benchmarks can report peak memory. Each block
+// carries its size in a header that keeps the default new alignment.
+namespace allocation_tracker
+{
+    constexpr size_t HEADER = alignof(std::max_align_t);
+    std::atomic<size_t> live{0};
+    std::atomic<size_t> peak{0};
+
+    void reset_peak() { peak.store(live.load()); }
+}
+
+void *operator new(size_t size)
+{
+    void *block = std::malloc(size + allocation_tracker::HEADER);
+    if (!block)
+        throw std::bad_alloc();
+    *static_cast<size_t *>(block) = size;
+
+    size_t now = allocation_tracker::live.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peak = allocation_tracker::peak.load(std::memory_order_relaxed);
+    while (now > peak && !allocation_tracker::peak.compare_exchange_weak(peak, now, std::memory_order_relaxed))
+    {
+    }
+    return static_cast<char *>(block) + allocation_tracker::HEADER;
+}
+
+void operator delete(void *ptr) noexcept
+{
+    if (!ptr)
+        return;
+    void *block = static_cast<char *>(ptr) - allocation_tracker::HEADER;
+    allocation_tracker::live.fetch_sub(*static_cast<size_t *>(block), std::memory_order_relaxed);
+    std::free(block);
+}
+
+void operator delete(void *ptr, size_t) noexcept { operator delete(ptr); }
+
 class BenchmarkResults
 {
 public:
@@ -279,6 +331,899 @@ void benchmark_iteration(size_t num_elements = 100000, size_t iterations = 10)
               << (std_result.mean_ms / dense_result.mean_ms) << "x faster" << std::endl;
 }
 
+void benchmark_parallel_algorithms(size_t num_elements = 1000000, size_t iterations = 10)
+{
+    BenchmarkResults results;
+    results.print_header("PARALLEL ALGORITHMS BENCHMARK (" + std::to_string(num_elements) + " elements)");
+
+    unordered_dense_map<int, int> dense_map;
+    dense_map.reserve(num_elements);
+    for (size_t i = 0; i < num_elements; ++i)
+    {
+        dense_map.emplace(static_cast<int>(i), static_cast<int>(i));
+    }
+
+    auto sum = [](long long a, long long b)
+    { return a + b; };
+    auto key_plus_value = [](const int &k, const int &v)
+    { return static_cast<long long>(k) + v; };
+    volatile long long sink = 0;
+
+    auto loop_result = benchmark_function([&]()
+                                          {
+        long long total = 0;
+        for (const auto& entry : dense_map) {
+            total += entry.key + entry.value;
+        }
+        sink = total; }, iterations, num_elements);
+    results.print_result("iterator loop", loop_result);
+
+    auto seq_result = benchmark_function([&]()
+                                         { sink = dense_map.reduce(dense_execution::seq, 0LL, sum, key_plus_value); },
+                                         iterations, num_elements);
+    results.print_result("reduce (seq)", seq_result);
+
+    auto par_result = benchmark_function([&]()
+                                         { sink = dense_map.reduce(dense_execution::par, 0LL, sum, key_plus_value); },
+                                         iterations, num_elements);
+    results.print_result("reduce (par)", par_result);
+
+    auto count_result = benchmark_function([&]()
+                                           { sink = dense_map.count_if(dense_execution::par, [](const int &k, const int &)
+                                                                       { return (k & 7) == 0; }); },
+                                           iterations, num_elements);
+    results.print_result("count_if (par)", count_result);
+
+    auto transform_result = benchmark_function([&]()
+                                               { dense_map.transform_values(dense_execution::par, [](const int &v)
+                                                                            { return v + 1; }); },
+                                               iterations, num_elements);
+    results.print_result("transform_values (par)", transform_result);
+    (void)sink;
+
+    std::cout << "\nreduce (par) vs iterator loop: " << std::setprecision(2)
+              << (loop_result.mean_ms / par_result.mean_ms) << "x" << std::endl;
+}
+
+void benchmark_sorted_export(size_t num_elements = 1000000, size_t iterations = 5)
+{
+    BenchmarkResults results;
+    results.print_header("SORTED EXPORT BENCHMARK (" + std::to_string(num_elements) + " elements)");
+
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> dis;
+    unordered_dense_map<int, int> dense_map;
+    dense_map.reserve(num_elements);
+    while (dense_map.size() < num_elements)
+    {
+        dense_map.emplace(dis(gen), static_cast<int>(dense_map.size()));
+    }
+
+    auto copy_sort_result = benchmark_function([&]()
+                                               {
+        std::vector<std::pair<int, int>> out;
+        out.reserve(dense_map.size());
+        for (const auto& entry : dense_map) {
+            out.emplace_back(entry.key, entry.value);
+        }
+        std::sort(out.begin(), out.end()); }, iterations, num_elements);
+    results.print_result("copy + std::sort", copy_sort_result);
+
+    auto export_result = benchmark_function([&]()
+                                            { auto out = dense_map.export_sorted(); }, iterations, num_elements);
+    results.print_result("export_sorted (radix)", export_result);
+
+    auto view_result = benchmark_function([&]()
+                                          { auto view = dense_map.sorted_view(); }, iterations, num_elements);
+    results.print_result("sorted_view (radix)", view_result);
+
+    std::cout << "\nexport_sorted vs copy + std::sort: " << std::setprecision(2)
+              << (copy_sort_result.mean_ms / export_result.mean_ms) << "x faster" << std::endl;
+}
+
+void benchmark_aggregation(size_t rows = 4000000, size_t groups = 1000000, size_t iterations = 3)
+{
+    BenchmarkResults results;
+    results.print_header("GROUP BY SUM BENCHMARK (" + std::to_string(rows) + " rows, " +
+                         std::to_string(groups) + " groups)");
+
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> key_dis(0, static_cast<int>(groups) - 1);
+    std::vector<int> keys(rows);
+    std::vector<long long> values(rows);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        keys[i] = key_dis(gen) * 7919;
+        values[i] = static_cast<long long>(i & 1023);
+    }
+
+    auto subscript_result = benchmark_function([&]()
+                                               {
+        unordered_dense_map<int, long long> totals;
+        for (size_t i = 0; i < rows; ++i) {
+            totals[keys[i]] += values[i];
+        } }, iterations, rows);
+    results.print_result("operator[] +=", subscript_result);
+
+    auto aggregate_result = benchmark_function([&]()
+                                               {
+        unordered_dense_map<int, long long> totals;
+        totals.aggregate(keys, values, dense_aggregate::sum{}); }, iterations, rows);
+    results.print_result("aggregate (sum)", aggregate_result);
+
+    std::cout << "\naggregate vs operator[]: " << std::setprecision(2)
+              << (subscript_result.mean_ms / aggregate_result.mean_ms) << "x faster" << std::endl;
+}
+
+void benchmark_hash_join(size_t build_rows = 1000000, size_t probe_rows = 4000000, size_t iterations = 3)
+{
+    BenchmarkResults results;
+    results.print_header("HASH JOIN PROBE BENCHMARK (" + std::to_string(build_rows) + " build, " +
+                         std::to_string(probe_rows) + " probe rows)");
+
+    std::mt19937 gen(5);
+    std::vector<int> build(build_rows);
+    for (size_t i = 0; i < build_rows; ++i)
+    {
+        build[i] = static_cast<int>(i) * 13;
+    }
+    std::uniform_int_distribution<int> dis(0, static_cast<int>(build_rows) * 26);
+    std::vector<int> probe(probe_rows);
+    for (auto &key : probe)
+    {
+        key = dis(gen);
+    }
+
+    unordered_dense_map<int, size_t> row_map;
+    for (size_t i = 0; i < build_rows; ++i)
+    {
+        row_map.emplace(build[i], i);
+    }
+    hash_join<int> join(build);
+
+    auto find_result = benchmark_function([&]()
+                                          {
+        join_matches out;
+        for (size_t i = 0; i < probe.size(); ++i) {
+            auto it = row_map.find(probe[i]);
+            if (it != row_map.end()) {
+                out.probe_rows.push_back(i);
+                out.build_rows.push_back(it->value);
+            }
+        } }, iterations, probe_rows);
+    results.print_result("find per row", find_result);
+
+    auto join_result = benchmark_function([&]()
+                                          {
+        join_matches out;
+        join.probe(join_type::inner, probe, out); }, iterations, probe_rows);
+    results.print_result("hash_join::probe", join_result);
+
+    std::cout << "\nhash_join vs find per row: " << std::setprecision(2)
+              << (find_result.mean_ms / join_result.mean_ms) << "x faster" << std::endl;
+}
+
+void benchmark_partitioned_build(size_t llc_multiple = 10, size_t max_elements = 32u << 20)
+{
+    long llc = 0;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+    size_t llc_bytes = llc > 0 ? static_cast<size_t>(llc) : (32u << 20);
+
+    // Table footprint per element: one entry plus ~2 buckets at typical load
+    const size_t bytes_per_element = 2 * sizeof(int) + 2 * sizeof(detail::Bucket);
+    size_t elements = std::min(llc_multiple * llc_bytes / bytes_per_element, max_elements);
+
+    BenchmarkResults results;
+    results.print_header("PARTITIONED BUILD BENCHMARK (" + std::to_string(elements) + " elements, ~" +
+                         std::to_string(elements * bytes_per_element / llc_bytes) + "x LLC)");
+
+    std::mt19937 gen(17);
+    std::vector<std::pair<int, int>> data(elements);
+    for (size_t i = 0; i < elements; ++i)
+    {
+        data[i] = {static_cast<int>(gen()), static_cast<int>(i)};
+    }
+
+    auto insert_result = benchmark_function([&]()
+                                            {
+        unordered_dense_map<int, int> map;
+        map.reserve(elements);
+        for (const auto& kv : data) {
+            map.insert(kv.first, kv.second);
+        } }, 1, elements);
+    results.print_result("reserve + insert loop", insert_result);
+
+    auto partitioned_result = benchmark_function([&]()
+                                                 {
+        unordered_dense_map<int, int> map;
+        map.build_partitioned(data); }, 1, elements);
+    results.print_result("build_partitioned", partitioned_result);
+
+    std::cout << "\nbuild_partitioned vs insert loop: " << std::setprecision(2)
+              << (insert_result.mean_ms / partitioned_result.mean_ms) << "x faster" << std::endl;
+}
+
+void benchmark_flat_lookup(size_t num_elements = 4000000, size_t iterations = 3)
+{
+    BenchmarkResults results;
+    results.print_header("FLAT vs DENSE LOOKUP BENCHMARK (" + std::to_string(num_elements) +
+                         " uint32_t -> uint32_t)");
+
+    std::mt19937 gen(23);
+    std::vector<uint32_t> keys(num_elements);
+    for (auto &key : keys)
+    {
+        key = gen();
+    }
+
+    unordered_dense_map<uint32_t, uint32_t> dense;
+    flat_dense_map<uint32_t, uint32_t> flat;
+    for (uint32_t key : keys)
+    {
+        dense[key] = key;
+        flat[key] = key;
+    }
+    std::shuffle(keys.begin(), keys.end(), gen);
+
+    auto dense_result = benchmark_function([&]()
+                                           {
+        uint64_t sum = 0;
+        for (uint32_t key : keys) {
+            sum += dense.find(key)->value;
+        }
+        volatile uint64_t sink = sum;
+        (void)sink; }, iterations, num_elements);
+    results.print_result("unordered_dense_map::find", dense_result);
+
+    auto flat_result = benchmark_function([&]()
+                                          {
+        uint64_t sum = 0;
+        for (uint32_t key : keys) {
+            sum += flat.find(key)->value;
+        }
+        volatile uint64_t sink = sum;
+        (void)sink; }, iterations, num_elements);
+    results.print_result("flat_dense_map::find", flat_result);
+
+    std::cout << "\nflat vs dense lookup: " << std::setprecision(2)
+              << (dense_result.mean_ms / flat_result.mean_ms) << "x faster" << std::endl;
+}
+
+void benchmark_split_layout(size_t num_elements = 1000000, size_t iterations = 5)
+{
+    struct Payload
+    {
+        long long id;
+        char bytes[192];
+    };
+
+    BenchmarkResults results;
+    results.print_header("SPLIT (SoA) vs DENSE LAYOUT BENCHMARK (" + std::to_string(num_elements) +
+                         " int -> 200-byte values)");
+
+    std::mt19937 gen(31);
+    unordered_dense_map<int, Payload> dense;
+    split_dense_map<int, Payload> split;
+    std::vector<int> probe(num_elements);
+    for (size_t i = 0; i < num_elements; ++i)
+    {
+        int key = static_cast<int>(gen());
+        dense[key].id = key;
+        split[key].id = key;
+        probe[i] = (i & 1) ? key : static_cast<int>(gen()); // Half hits, half (likely) misses
+    }
+    std::shuffle(probe.begin(), probe.end(), gen);
+
+    auto dense_scan = benchmark_function([&]()
+                                         {
+        long long sum = 0;
+        for (const auto &entry : dense) {
+            sum += entry.key;
+        }
+        volatile long long sink = sum;
+        (void)sink; }, iterations, num_elements);
+    results.print_result("dense: key scan", dense_scan);
+
+    auto split_scan = benchmark_function([&]()
+                                         {
+        long long sum = 0;
+        for (int key : split.keys()) {
+            sum += key;
+        }
+        volatile long long sink = sum;
+        (void)sink; }, iterations, num_elements);
+    results.print_result("split: keys() scan", split_scan);
+
+    auto dense_lookup = benchmark_function([&]()
+                                           {
+        size_t found = 0;
+        for (int key : probe) {
+            found += dense.contains(key);
+        }
+        volatile size_t sink = found;
+        (void)sink; }, iterations, num_elements);
+    results.print_result("dense: contains", dense_lookup);
+
+    auto split_lookup = benchmark_function([&]()
+                                           {
+        size_t found = 0;
+        for (int key : probe) {
+            found += split.contains(key);
+        }
+        volatile size_t sink = found;
+        (void)sink; }, iterations, num_elements);
+    results.print_result("split: contains", split_lookup);
+
+    std::cout << "\nsplit vs dense: key scan " << std::setprecision(2) << (dense_scan.mean_ms / split_scan.mean_ms)
+              << "x, contains " << (dense_lookup.mean_ms / split_lookup.mean_ms) << "x" << std::endl;
+}
+
+void benchmark_snapshot(size_t num_elements = 4000000, size_t iterations = 5)
+{
+    using cow_map = unordered_dense_map<int, long long, detail::hash_traits<int>, dense_storage::copy_on_write<>>;
+
+    BenchmarkResults results;
+    results.print_header("SNAPSHOT BENCHMARK (" + std::to_string(num_elements) + " elements)");
+
+    unordered_dense_map<int, long long> plain;
+    cow_map cow;
+    plain.reserve(num_elements);
+    cow.reserve(num_elements);
+    for (size_t i = 0; i < num_elements; ++i)
+    {
+        int key = static_cast<int>(i * 2654435761u);
+        plain[key] = static_cast<long long>(i);
+        cow[key] = static_cast<long long>(i);
+    }
+
+    auto copy_result = benchmark_function([&]()
+                                          {
+        unordered_dense_map<int, long long> copy = plain;
+        volatile size_t sink = copy.size();
+        (void)sink; }, iterations, 1);
+    results.print_result("deep copy (contiguous)", copy_result);
+
+    auto snapshot_result = benchmark_function([&]()
+                                              {
+        cow_map copy = cow.snapshot();
+        volatile size_t sink = copy.size();
+        (void)sink; }, iterations, 1);
+    results.print_result("snapshot (copy_on_write)", snapshot_result);
+
+    // What the writer pays afterwards: 1000 scattered updates, each of which
+    // copies the chunk it lands in
+    auto write_result = benchmark_function([&]()
+                                           {
+        cow_map copy = cow.snapshot();
+        for (size_t i = 0; i < 1000; ++i) {
+            cow[static_cast<int>((i * 4099 % num_elements) * 2654435761u)] += 1;
+        } }, iterations, 1000);
+    results.print_result("1000 writes after snapshot", write_result);
+
+    std::cout << "\nsnapshot vs deep copy: " << std::setprecision(2)
+              << (copy_result.mean_ms / snapshot_result.mean_ms) << "x faster" << std::endl;
+}
+
+void benchmark_chunked_growth(size_t num_elements = 4000000, size_t iterations = 3)
+{
+    using chunked_map = unordered_dense_map<int, long long, detail::hash_traits<int>, dense_storage::chunked<>>;
+
+    BenchmarkResults results;
+    results.print_header("GROWTH WITHOUT RESERVE (" + std::to_string(num_elements) + " elements)");
+
+    // Peak heap bytes while building one map from empty
+    size_t contiguous_peak = 0;
+    size_t chunked_peak = 0;
+    auto build = [&](auto map, size_t &peak)
+    {
+        size_t before = allocation_tracker::live.load();
+        allocation_tracker::reset_peak();
+        for (size_t i = 0; i < num_elements; ++i)
+        {
+            map[static_cast<int>(i * 2654435761u)] = static_cast<long long>(i);
+        }
+        peak = allocation_tracker::peak.load() - before;
+        volatile size_t sink = map.size();
+        (void)sink;
+    };
+
+    auto contiguous_result = benchmark_function([&]()
+                                                { build(unordered_dense_map<int, long long>(), contiguous_peak); },
+                                                iterations, num_elements);
+    results.print_result("contiguous", contiguous_result);
+
+    auto chunked_result = benchmark_function([&]()
+                                             { build(chunked_map(), chunked_peak); },
+                                             iterations, num_elements);
+    results.print_result("chunked", chunked_result);
+
+    const double mb = 1024.0 * 1024.0;
+    std::cout << "\npeak heap during growth: contiguous " << std::setprecision(1) << contiguous_peak / mb
+              << " MB, chunked " << chunked_peak / mb << " MB (entries alone: "
+              << num_elements * sizeof(chunked_map::value_type) / mb << " MB)" << std::endl;
+}
+
+void benchmark_spilling(size_t num_keys = 4000000, size_t max_resident = 500000, size_t iterations = 3)
+{
+    BenchmarkResults results;
+    results.print_header("SPILLING MAP (" + std::to_string(num_keys) + " keys x 2, " +
+                         std::to_string(max_resident) + " resident)");
+
+    const auto directory = std::filesystem::temp_directory_path() / "udm_spill_bench";
+    auto key_at = [](size_t i)
+    { return static_cast<int>(i * 2654435761u); };
+
+    auto memory_result = benchmark_function([&]()
+                                            {
+        unordered_dense_map<int, long long> counts;
+        for (size_t round = 0; round < 2; ++round) {
+            for (size_t i = 0; i < num_keys; ++i) {
+                auto [it, inserted] = counts.try_emplace(key_at(i), 1);
+                if (!inserted) it->value += 1;
+            }
+        }
+        volatile size_t sink = counts.size();
+        (void)sink; }, iterations, 2 * num_keys);
+    results.print_result("in memory", memory_result);
+
+    size_t spilled = 0;
+    auto spill_result = benchmark_function([&]()
+                                           {
+        spilling_dense_map<int, long long, std::plus<long long>> counts(directory, max_resident, 64);
+        for (size_t round = 0; round < 2; ++round) {
+            for (size_t i = 0; i < num_keys; ++i) {
+                counts.insert(key_at(i), 1);
+            }
+        }
+        size_t keys = 0;
+        counts.for_each_partition([&](size_t, auto &partition) { keys += partition.size(); });
+        spilled = counts.spilled_records();
+        volatile size_t sink = keys;
+        (void)sink; }, iterations, 2 * num_keys);
+    results.print_result("spilling (build + scan)", spill_result);
+    std::filesystem::remove(directory);
+
+    std::cout << "\nspilled " << spilled << " records (" << std::setprecision(1)
+              << spilled * sizeof(unordered_dense_map<int, long long>::value_type) / (1024.0 * 1024.0) << " MB) in sequential writes"
+              << std::endl;
+}
+
+void benchmark_group_commit(size_t num_ops = 200000, size_t iterations = 3)
+{
+    BenchmarkResults results;
+    results.print_header("WRITE-AHEAD LOG GROUP COMMIT (inserts, fsync per group)");
+
+    const auto directory = std::filesystem::temp_directory_path() / "udm_wal_bench";
+    auto run = [&](size_t group, size_t ops)
+    {
+        return benchmark_function([&]()
+                                  {
+            std::filesystem::remove_all(directory);
+            durable_dense_map<int, long long> map(directory, {group, 0});
+            for (size_t i = 0; i < ops; ++i) {
+                map.insert(static_cast<int>(i), static_cast<long long>(i));
+            }
+            map.commit(); }, iterations, ops);
+    };
+
+    // fsync per insert is slow enough that a smaller run tells the story
+    auto single = run(1, num_ops / 100);
+    results.print_result("group of 1", single);
+    auto grouped = run(512, num_ops);
+    results.print_result("group of 512", grouped);
+    std::filesystem::remove_all(directory);
+
+    std::cout << "\ngroup commit: " << std::setprecision(1)
+              << static_cast<double>(grouped.operations_per_second) / single.operations_per_second
+              << "x the inserts per second" << std::endl;
+}
+
+void benchmark_constexpr_lookup(size_t lookups = 10000000, size_t iterations = 5)
+{
+    BenchmarkResults results;
+    results.print_header("STATIC KEYWORD TABLE (" + std::to_string(lookups) + " lookups)");
+
+    static constexpr auto keywords = make_constexpr_dense_map<std::string_view, int>(
+        {{"auto", 0}, {"break", 1}, {"case", 2}, {"char", 3}, {"const", 4}, {"continue", 5}, {"default", 6},
+         {"do", 7}, {"double", 8}, {"else", 9}, {"enum", 10}, {"extern", 11}, {"float", 12}, {"for", 13},
+         {"goto", 14}, {"if", 15}, {"int", 16}, {"long", 17}, {"register", 18}, {"return", 19}, {"short", 20},
+         {"signed", 21}, {"sizeof", 22}, {"static", 23}, {"struct", 24}, {"switch", 25}, {"typedef", 26},
+         {"union", 27}, {"unsigned", 28}, {"void", 29}, {"volatile", 30}, {"while", 31}});
+
+    // Identifiers as a lexer sees them: mostly keywords, some plain names
+    std::vector<std::string> words;
+    for (const auto &entry : keywords)
+    {
+        words.emplace_back(entry.key);
+        words.push_back(std::string(entry.key) + "_id");
+    }
+
+    unordered_dense_map<std::string, int> runtime_table;
+    for (const auto &entry : keywords)
+    {
+        runtime_table[std::string(entry.key)] = entry.value;
+    }
+
+    auto runtime_result = benchmark_function([&]()
+                                             {
+        long long sum = 0;
+        for (size_t i = 0; i < lookups; ++i) {
+            auto it = runtime_table.find(words[i % words.size()]);
+            sum += it == runtime_table.end() ? -1 : it->value;
+        }
+        volatile long long sink = sum;
+        (void)sink; }, iterations, lookups);
+    results.print_result("unordered_dense_map", runtime_result);
+
+    auto constexpr_result = benchmark_function([&]()
+                                               {
+        long long sum = 0;
+        for (size_t i = 0; i < lookups; ++i) {
+            sum += keywords.value_or(words[i % words.size()], -1);
+        }
+        volatile long long sink = sum;
+        (void)sink; }, iterations, lookups);
+    results.print_result("constexpr_dense_map", constexpr_result);
+}
+
+void benchmark_static_map(size_t groups = 200000, size_t iterations = 5)
+{
+    BenchmarkResults results;
+    results.print_header("SMALL MAP IN AN INNER LOOP (" + std::to_string(groups) + " groups of 32 keys)");
+
+    constexpr size_t GROUP = 32;
+    std::vector<uint32_t> keys(groups * GROUP);
+    std::mt19937 gen(42);
+    for (auto &key : keys)
+    {
+        key = gen() % 24; // Repeats within a group
+    }
+
+    auto heap_result = benchmark_function([&]()
+                                          {
+        size_t distinct = 0;
+        for (size_t g = 0; g < groups; ++g) {
+            unordered_dense_map<uint32_t, uint32_t> counts;
+            for (size_t i = g * GROUP; i < (g + 1) * GROUP; ++i) {
+                auto [it, inserted] = counts.try_emplace(keys[i], 0u);
+                it->value += 1;
+            }
+            distinct += counts.size();
+        }
+        volatile size_t sink = distinct;
+        (void)sink; }, iterations, groups * GROUP);
+    results.print_result("unordered_dense_map", heap_result);
+
+    auto static_result = benchmark_function([&]()
+                                            {
+        size_t distinct = 0;
+        for (size_t g = 0; g < groups; ++g) {
+            static_dense_map<uint32_t, uint32_t, GROUP> counts;
+            for (size_t i = g * GROUP; i < (g + 1) * GROUP; ++i) {
+                auto [it, inserted] = counts.try_emplace(keys[i], 0u);
+                it->value += 1;
+            }
+            distinct += counts.size();
+        }
+        volatile size_t sink = distinct;
+        (void)sink; }, iterations, groups * GROUP);
+    results.print_result("static_dense_map", static_result);
+}
+
+void benchmark_prefetched_lookup(size_t size = 4000000, size_t iterations = 3)
+{
+    BenchmarkResults results;
+    results.print_header("LOOKUPS WITH UPSTREAM HASHES (" + std::to_string(size) + " keys)");
+
+    using Hash = detail::hash_traits<uint64_t>;
+    unordered_dense_map<uint64_t, uint64_t> map;
+    map.reserve(size);
+    std::mt19937_64 gen(42);
+    std::vector<uint64_t> keys(size);
+    for (auto &key : keys)
+    {
+        key = gen();
+        map.insert(key, key);
+    }
+    std::shuffle(keys.begin(), keys.end(), gen);
+
+    // Hashes as an upstream partitioning step would already hold them
+    std::vector<uint64_t> hashes(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hashes[i] = Hash::hash(keys[i]);
+    }
+
+    auto find_result = benchmark_function([&]()
+                                          {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < size; ++i) {
+            sum += map.find(keys[i])->value;
+        }
+        volatile uint64_t sink = sum;
+        (void)sink; }, iterations, size);
+    results.print_result("find", find_result);
+
+    auto hashed_result = benchmark_function([&]()
+                                            {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < size; ++i) {
+            sum += map.find_hashed(keys[i], hashes[i])->value;
+        }
+        volatile uint64_t sink = sum;
+        (void)sink; }, iterations, size);
+    results.print_result("find_hashed", hashed_result);
+
+    constexpr size_t DISTANCE = 16;
+    auto prefetch_result = benchmark_function([&]()
+                                              {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < size; ++i) {
+            if (i + DISTANCE < size) {
+                map.prefetch(hashes[i + DISTANCE]);
+            }
+            sum += map.find_hashed(keys[i], hashes[i])->value;
+        }
+        volatile uint64_t sink = sum;
+        (void)sink; }, iterations, size);
+    results.print_result("prefetch + find_hashed", prefetch_result);
+}
+
+void benchmark_slot_handles(size_t size = 1000000, size_t iterations = 3)
+{
+    BenchmarkResults results;
+    results.print_header("REPEATED ACCESS BY KEY VS HANDLE (" + std::to_string(size) + " string keys)");
+
+    slot_dense_map<std::string, uint64_t> map;
+    std::vector<std::string> keys(size);
+    std::vector<slot_dense_map<std::string, uint64_t>::handle> handles(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        keys[i] = "vertex-" + std::to_string(i);
+        handles[i] = map.insert(keys[i], i).first;
+    }
+
+    // Edge list as a graph index would walk it
+    std::mt19937_64 gen(42);
+    std::vector<uint32_t> edges(size * 4);
+    for (auto &edge : edges)
+    {
+        edge = static_cast<uint32_t>(gen() % size);
+    }
+
+    auto key_result = benchmark_function([&]()
+                                         {
+        uint64_t sum = 0;
+        for (uint32_t edge : edges) {
+            sum += map.at(keys[edge]);
+        }
+        volatile uint64_t sink = sum;
+        (void)sink; }, iterations, edges.size());
+    results.print_result("at(key)", key_result);
+
+    auto handle_result = benchmark_function([&]()
+                                            {
+        uint64_t sum = 0;
+        for (uint32_t edge : edges) {
+            sum += *map.get(handles[edge]);
+        }
+        volatile uint64_t sink = sum;
+        (void)sink; }, iterations, edges.size());
+    results.print_result("get(handle)", handle_result);
+}
+
+void benchmark_bloom_filter(size_t size = 4000000, size_t iterations = 3)
+{
+    BenchmarkResults results;
+    results.print_header("MISS-HEAVY LOOKUPS, 95% ABSENT (" + std::to_string(size) + " keys)");
+
+    std::mt19937_64 gen(42);
+    std::vector<uint64_t> keys(size);
+    for (auto &key : keys)
+    {
+        key = gen();
+    }
+    unordered_dense_map<uint64_t, uint64_t> plain;
+    plain.reserve(size);
+    for (uint64_t key : keys)
+    {
+        plain.insert(key, key);
+    }
+    unordered_dense_map<uint64_t, uint64_t> filtered = plain;
+    filtered.set_bloom_filter(true);
+
+    std::vector<uint64_t> probe(size);
+    for (auto &key : probe)
+    {
+        key = gen() % 20 == 0 ? keys[gen() % size] : gen();
+    }
+
+    for (auto *map : {&plain, &filtered})
+    {
+        const std::string name = map->has_bloom_filter() ? "with filter" : "no filter";
+        auto contains_result = benchmark_function([&]()
+                                                  {
+            size_t hits = 0;
+            for (uint64_t key : probe) {
+                hits += map->contains(key);
+            }
+            volatile size_t sink = hits;
+            (void)sink; }, iterations, size);
+        results.print_result("contains, " + name, contains_result);
+
+        auto batch_result = benchmark_function([&]()
+                                               {
+            auto found = map->batch_contains(probe.begin(), probe.end());
+            volatile bool sink = found[0];
+            (void)sink; }, iterations, size);
+        results.print_result("batch, " + name, batch_result);
+    }
+}
+
+void benchmark_cuckoo_filter(size_t size = 4000000, size_t iterations = 3)
+{
+    BenchmarkResults results;
+    results.print_header("APPROXIMATE MEMBERSHIP PRE-FILTER (" + std::to_string(size) + " keys)");
+
+    std::mt19937_64 gen(42);
+    unordered_dense_map<uint64_t, uint64_t> map;
+    map.reserve(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        map.insert(gen(), i);
+    }
+    auto filter = cuckoo_filter<uint64_t>::from_map(map);
+
+    std::vector<uint64_t> probe(size);
+    for (auto &key : probe)
+    {
+        key = gen();
+    }
+    std::vector<uint64_t> hashes(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hashes[i] = detail::hash_traits<uint64_t>::hash(probe[i]);
+    }
+
+    auto map_result = benchmark_function([&]()
+                                         {
+        auto found = map.batch_contains(probe.begin(), probe.end());
+        volatile bool sink = found[0];
+        (void)sink; }, iterations, size);
+    results.print_result("map batch_contains", map_result);
+
+    auto scalar_result = benchmark_function([&]()
+                                            {
+        size_t hits = 0;
+        for (uint64_t hash : hashes) {
+            hits += filter.contains_hashed(hash);
+        }
+        volatile size_t sink = hits;
+        (void)sink; }, iterations, size);
+    results.print_result("filter contains", scalar_result);
+
+    auto batch_result = benchmark_function([&]()
+                                           {
+        auto found = filter.batch_contains_hashed(hashes);
+        volatile bool sink = found[0];
+        (void)sink; }, iterations, size);
+    results.print_result("filter batch", batch_result);
+
+    std::cout << "Filter: " << std::fixed << std::setprecision(2)
+              << static_cast<double>(filter.memory_bytes()) / size << " bytes per key" << std::endl;
+}
+
+void benchmark_cuckoo_index(size_t size = 4000000, size_t iterations = 3)
+{
+    BenchmarkResults results;
+    results.print_header("ROBIN-HOOD VS BUCKETIZED CUCKOO INDEX (" + std::to_string(size) + " keys)");
+
+    std::mt19937_64 gen(42);
+    std::vector<uint64_t> keys(size);
+    for (auto &key : keys)
+    {
+        key = gen();
+    }
+    std::vector<uint64_t> probe(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        probe[i] = i % 2 ? keys[gen() % size] : gen(); // Half hits
+    }
+
+    unordered_dense_map<uint64_t, uint64_t> robin_hood;
+    cuckoo_dense_map<uint64_t, uint64_t> cuckoo;
+    auto robin_hood_insert = benchmark_function([&]()
+                                                {
+        robin_hood = unordered_dense_map<uint64_t, uint64_t>();
+        robin_hood.reserve(size);
+        for (uint64_t key : keys) {
+            robin_hood.insert(key, key);
+        } }, iterations, size);
+    results.print_result("robin-hood insert", robin_hood_insert);
+
+    auto cuckoo_insert = benchmark_function([&]()
+                                            {
+        cuckoo = cuckoo_dense_map<uint64_t, uint64_t>();
+        cuckoo.reserve(size);
+        for (uint64_t key : keys) {
+            cuckoo.insert(key, key);
+        } }, iterations, size);
+    results.print_result("cuckoo insert", cuckoo_insert);
+
+    auto robin_hood_find = benchmark_function([&]()
+                                              {
+        size_t hits = 0;
+        for (uint64_t key : probe) {
+            hits += robin_hood.contains(key);
+        }
+        volatile size_t sink = hits;
+        (void)sink; }, iterations, size);
+    results.print_result("robin-hood find", robin_hood_find);
+
+    auto cuckoo_find = benchmark_function([&]()
+                                          {
+        size_t hits = 0;
+        for (uint64_t key : probe) {
+            hits += cuckoo.contains(key);
+        }
+        volatile size_t sink = hits;
+        (void)sink; }, iterations, size);
+    results.print_result("cuckoo find", cuckoo_find);
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Index load: robin-hood " << static_cast<double>(size) / robin_hood.bucket_count()
+              << ", cuckoo " << cuckoo.load_factor() << std::endl;
+    std::cout << "Index bytes per key: robin-hood "
+              << static_cast<double>(robin_hood.bucket_count() * sizeof(detail::Bucket)) / size
+              << ", cuckoo " << static_cast<double>(cuckoo.bucket_count() * 8) / size << std::endl;
+}
+
+void benchmark_dispatch_overhead(size_t threads = 4, size_t calls = 1000)
+{
+    BenchmarkResults results;
+    results.print_header("PARALLEL DISPATCH OVERHEAD (" + std::to_string(threads) + " threads, 64 tiny tasks per call)");
+
+    constexpr size_t TASKS = 64;
+    std::atomic<size_t> counter{0};
+
+    auto spawn_result = benchmark_function([&]()
+                                           {
+        for (size_t c = 0; c < calls; ++c)
+        {
+            std::atomic<size_t> next{0};
+            std::vector<std::thread> pool;
+            for (size_t t = 0; t < threads; ++t)
+            {
+                pool.emplace_back([&]() {
+                    while (next.fetch_add(1) < TASKS)
+                    {
+                        counter.fetch_add(1, std::memory_order_relaxed);
+                    }
+                });
+            }
+            for (auto &thread : pool)
+            {
+                thread.join();
+            }
+        } }, 3, calls);
+    results.print_result("std::thread per call", spawn_result);
+
+    work_stealing_executor pool(threads);
+    auto pool_result = benchmark_function([&]()
+                                          {
+        for (size_t c = 0; c < calls; ++c)
+        {
+            pool.bulk(TASKS, 0, [&](size_t) { counter.fetch_add(1, std::memory_order_relaxed); });
+        } }, 3, calls);
+    results.print_result("work_stealing_executor", pool_result);
+
+    std::cout << "\nPer-call dispatch: " << std::setprecision(2)
+              << (spawn_result.mean_ms * 1000.0 / calls) << " us (spawn) vs "
+              << (pool_result.mean_ms * 1000.0 / calls) << " us (pool)" << std::endl;
+}
+
 void benchmark_concurrent_operations()
 {
     BenchmarkResults results;
@@ -411,6 +1356,25 @@ int main()
         benchmark_insertion(100000, 5);
         benchmark_lookup(100000, 50000, 5);
         benchmark_iteration(100000, 10);
+        benchmark_parallel_algorithms(1000000, 10);
+        benchmark_sorted_export(1000000, 5);
+        benchmark_aggregation(4000000, 1000000, 3);
+        benchmark_hash_join(1000000, 4000000, 3);
+        benchmark_partitioned_build(10, 32u << 20);
+        benchmark_flat_lookup(4000000, 3);
+        benchmark_split_layout(1000000, 5);
+        benchmark_snapshot(4000000, 5);
+        benchmark_chunked_growth(4000000, 3);
+        benchmark_spilling(4000000, 500000, 3);
+        benchmark_group_commit(200000, 3);
+        benchmark_constexpr_lookup(10000000, 5);
+        benchmark_static_map(200000, 5);
+        benchmark_prefetched_lookup(4000000, 3);
+        benchmark_slot_handles(1000000, 3);
+        benchmark_bloom_filter(4000000, 3);
+        benchmark_cuckoo_filter(4000000, 3);
+        benchmark_cuckoo_index(4000000, 3);
+        benchmark_dispatch_overhead(4, 1000);
         // benchmark_concurrent_operations(); // DISABLED due to bugs
         benchmark_memory_usage();
 
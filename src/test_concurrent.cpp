@@ -1,9 +1,15 @@
 #include "../include/concurrent_unordered_dense_map.hpp"
+#include "../include/sharded_unordered_dense_map.hpp"
+#include "../include/thread_local_aggregator.hpp"
+#include "../include/work_stealing_executor.hpp"
 #include <iostream>
+#include <atomic>
 #include <chrono>
+#include <memory>
 #include <random>
 #include <thread>
 #include <vector>
+#include <stdexcept>
 #include <cassert>
 
 using namespace std::chrono;
@@ -145,6 +151,391 @@ void test_concurrent_multithreaded()
     std::cout << "✓ Concurrent multi-threaded operations completed!" << std::endl;
 }
 
+void test_segment_splitting()
+{
+    std::cout << "\n=== Testing Extendible Segment Splitting ===" << std::endl;
+
+    concurrent_unordered_dense_map<int, int> map;
+    const size_t initial_segments = map.segment_count();
+    const int num_threads = 4;
+    const int keys_per_thread = 250000;
+
+    // Keys present throughout; a reader checks them while segments split
+    // and the directory doubles under it
+    const int stable_keys = 2000;
+    for (int key = 1; key <= stable_keys; ++key)
+    {
+        map.insert(-key, -key * 2);
+    }
+    std::atomic<bool> writing{true};
+    std::atomic<size_t> missed{0};
+    std::thread reader([&]()
+                       {
+        while (writing.load())
+        {
+            for (int key = 1; key <= stable_keys; ++key)
+            {
+                map.prefetch(detail::hash_traits<int>::hash(-key)); // Lock-free, so it races with splits
+                if (!map.contains(-key))
+                {
+                    missed.fetch_add(1);
+                }
+            }
+        } });
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([&, t]()
+                             {
+            for (int i = 0; i < keys_per_thread; ++i)
+            {
+                int key = t * keys_per_thread + i;
+                map.insert(key, key * 2);
+                if (i % 4 == 0)
+                {
+                    map.erase(key);
+                }
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    writing.store(false);
+    reader.join();
+    assert(missed.load() == 0);
+
+    const size_t expected = static_cast<size_t>(num_threads) * keys_per_thread * 3 / 4 + stable_keys;
+    assert(map.size() == expected);
+    assert(map.segment_count() > initial_segments);
+    assert(map.global_depth() > 6);
+
+    for (int key = 0; key < num_threads * keys_per_thread; ++key)
+    {
+        bool present = (key % keys_per_thread) % 4 != 0;
+        assert(map.contains(key) == present);
+    }
+
+    size_t iterated = 0;
+    for (auto it = map.begin(); it != map.end(); ++it)
+    {
+        assert(it->second == it->first * 2);
+        ++iterated;
+    }
+    assert(iterated == expected);
+
+    std::cout << "Segments: " << initial_segments << " -> " << map.segment_count()
+              << " (global depth " << map.global_depth() << ")" << std::endl;
+    std::cout << "✓ Segment splitting tests passed!" << std::endl;
+}
+
+// Keys below 2^20 share their low 12 hash bits and all land in one segment
+struct clustered_hash
+{
+    static uint64_t hash(int key) { return static_cast<uint64_t>(key) << 12; }
+};
+
+struct constant_hash
+{
+    static uint64_t hash(int) { return 42; }
+};
+
+// Keys 0-149 and 256 hash to 0, keys 150-255 to 1, the rest to themselves
+struct two_run_hash
+{
+    static uint64_t hash(int key) { return key < 150 || key == 256 ? 0 : key < 256 ? 1 : static_cast<uint64_t>(key); }
+};
+
+void test_clustered_inserts()
+{
+    std::cout << "\n=== Testing Clustered Inserts ===" << std::endl;
+
+    // Runs longer than the probe limit grow the segment instead of being
+    // reported as duplicate keys
+    concurrent_unordered_dense_map<int, int, clustered_hash> map;
+    for (int key = 0; key < 1000; ++key)
+    {
+        assert(map.insert(key, key));
+    }
+    assert(map.size() == 1000 && !map.insert(999, 0));
+    for (int key = 0; key < 1000; ++key)
+    {
+        assert(map.find(key) != map.end() && map.find(key)->second == key);
+    }
+
+    // Keys with one hash cannot be spread, and are refused
+    concurrent_unordered_dense_map<int, int, constant_hash> same;
+    bool refused = false;
+    try
+    {
+        for (int key = 0; key < 1000; ++key)
+        {
+            same.insert(key, key);
+        }
+    }
+    catch (const std::length_error &)
+    {
+        refused = true;
+    }
+    assert(refused && same.size() >= 255 && same.contains(0));
+
+    // Key 256 reuses key 0's tombstone at distance 0, but a rebuild in entry
+    // order would place it 255 buckets from home, past the probe limit. The
+    // resize must keep the old index rather than lose it.
+    concurrent_unordered_dense_map<int, int, two_run_hash> runs;
+    for (int key = 0; key < 256; ++key)
+    {
+        assert(runs.insert(key, key));
+    }
+    assert(runs.erase(0) && runs.insert(256, 256));
+    for (int key = 300; key < 500; ++key)
+    {
+        assert(runs.insert(key, key));
+    }
+    assert(runs.size() == 456 && !runs.insert(256, 0));
+    for (int key = 1; key < 500; ++key)
+    {
+        assert(runs.contains(key) == (key <= 256 || key >= 300));
+    }
+
+    std::cout << "✓ Clustered insert tests passed!" << std::endl;
+}
+
+void test_concurrent_precomputed_hash()
+{
+    std::cout << "\n=== Testing Concurrent Precomputed-Hash API ===" << std::endl;
+
+    using Hash = detail::hash_traits<int>;
+    concurrent_unordered_dense_map<int, int> map;
+    const int num_threads = 4;
+    const int keys_per_thread = 50000;
+
+    // Enough keys to split segments while hashes are supplied by the caller
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([&, t]()
+                             {
+            for (int i = 0; i < keys_per_thread; ++i)
+            {
+                int key = t * keys_per_thread + i;
+                uint64_t hash = Hash::hash(key);
+                map.prefetch(hash);
+                assert(map.insert_hashed(key, hash, key * 3));
+                if (i % 5 == 0)
+                {
+                    assert(map.erase_hashed(key, hash));
+                }
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+
+    for (int key = 0; key < num_threads * keys_per_thread; ++key)
+    {
+        uint64_t hash = Hash::hash(key);
+        auto it = map.find_hashed(key, hash);
+        bool present = (key % keys_per_thread) % 5 != 0;
+        assert((it != map.end()) == present);
+        assert(map.contains_hashed(key, hash) == present);
+        if (present)
+        {
+            assert(it->second == key * 3);
+        }
+    }
+    assert(!map.insert_hashed(1, Hash::hash(1), 0));
+    assert(map.size() == static_cast<size_t>(num_threads) * keys_per_thread * 4 / 5);
+
+    std::cout << "✓ Concurrent precomputed-hash tests passed!" << std::endl;
+}
+
+void test_sharded_map()
+{
+    std::cout << "\n=== Testing Sharded Map (owner-thread message passing) ===" << std::endl;
+
+    sharded_unordered_dense_map<int, int> map(4, 64);
+
+    assert(map.insert(1, 10).get());
+    assert(!map.insert(1, 11).get());
+    assert(map.find(1).get() == std::optional<int>(10));
+    assert(!map.find(2).get().has_value());
+
+    const int num_threads = 4;
+    const int ops_per_thread = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([&, t]()
+                             {
+            for (int i = 0; i < ops_per_thread; ++i)
+            {
+                map.assign(t * ops_per_thread + i, i);
+                map.update(-1, [](int &counter) { ++counter; });
+            } });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    map.flush();
+
+    assert(map.size() == static_cast<size_t>(num_threads * ops_per_thread) + 1);
+    assert(map.find(-1).get() == std::optional<int>(num_threads * ops_per_thread));
+    assert(map.find(3 * ops_per_thread + 7).get() == std::optional<int>(7));
+
+    std::vector<std::pair<int, int>> batch;
+    for (int i = 0; i < 1000; ++i)
+    {
+        batch.emplace_back(i, -i);
+    }
+    map.batch_assign(batch.begin(), batch.end());
+    assert(map.find(999).get() == std::optional<int>(-999));
+
+    std::promise<int> seen;
+    map.find(999, [&](const int *value)
+             { seen.set_value(value ? *value : 0); });
+    assert(seen.get_future().get() == -999);
+
+    // Callbacks may own move-only state.
+    auto bonus = std::make_unique<int>(5);
+    map.update(998, [bonus = std::move(bonus)](int &value)
+               { value += *bonus; });
+    assert(map.find(998).get() == std::optional<int>(-993));
+
+    // A throwing callback leaves the owner running and surfaces from flush().
+    map.update(997, [](int &)
+               { throw std::runtime_error("callback failed"); });
+    bool thrown = false;
+    try
+    {
+        map.flush();
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+    map.flush();
+    assert(map.find(996).get() == std::optional<int>(-996));
+
+    assert(map.erase(999).get());
+    assert(!map.erase(999).get());
+    assert(!map.find(999).get().has_value());
+
+    std::cout << "✓ Sharded map tests passed!" << std::endl;
+}
+
+void test_thread_local_aggregator()
+{
+    std::cout << "\n=== Testing Thread-Local Aggregation ===" << std::endl;
+
+    thread_local_aggregator<int, long long> counts;
+    const int num_threads = 4;
+    const int ops_per_thread = 20000;
+    const int distinct_keys = 1000;
+
+    for (int round = 0; round < 2; ++round)
+    {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; ++t)
+        {
+            threads.emplace_back([&]()
+                                 {
+                for (int i = 0; i < ops_per_thread; ++i)
+                {
+                    counts.add(i % distinct_keys, 1);
+                } });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+
+        if (round == 0)
+        {
+            auto merged = counts.merge(4);
+            assert(merged.size() == static_cast<size_t>(distinct_keys));
+            for (int k = 0; k < distinct_keys; ++k)
+            {
+                assert(merged.at(k) == num_threads * ops_per_thread / distinct_keys);
+            }
+        }
+        else
+        {
+            concurrent_unordered_dense_map<int, long long> merged;
+            counts.merge_into(merged, 4);
+            assert(merged.size() == static_cast<size_t>(distinct_keys));
+            assert(merged.contains(0) && merged.contains(distinct_keys - 1));
+        }
+    }
+
+    assert(counts.merge(2).empty());
+
+    std::cout << "✓ Thread-local aggregation tests passed!" << std::endl;
+}
+
+void test_work_stealing_executor()
+{
+    std::cout << "\n=== Testing Work-Stealing Executor ===" << std::endl;
+
+    work_stealing_executor pool(4);
+    assert(pool.concurrency() == 4);
+
+    std::vector<std::atomic<int>> hits(10000);
+    pool.bulk(hits.size(), 0, [&](size_t i)
+              { hits[i].fetch_add(1); });
+    for (auto &h : hits)
+    {
+        assert(h.load() == 1);
+    }
+
+    // Nested bulk calls from inside tasks must not deadlock the pool
+    std::atomic<size_t> nested{0};
+    pool.bulk(16, 0, [&](size_t)
+              { pool.bulk(64, 0, [&](size_t)
+                          { nested.fetch_add(1); }); });
+    assert(nested.load() == 16 * 64);
+
+    bool thrown = false;
+    try
+    {
+        pool.bulk(100, 0, [](size_t i)
+                  {
+            if (i == 42)
+            {
+                throw std::runtime_error("task failed");
+            } });
+    }
+    catch (const std::runtime_error &)
+    {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Library parallelism runs on whichever executor is installed
+    dense_execution::set_default_executor(&pool);
+    assert(&dense_execution::default_executor() == &pool);
+
+    std::vector<std::pair<int, int>> input;
+    for (int i = 0; i < 100000; ++i)
+    {
+        input.emplace_back(i, -i);
+    }
+    unordered_dense_map<int, int> built;
+    built.parallel_build(input.begin(), input.end(), 4);
+    assert(built.size() == input.size());
+    assert(built.count_if(dense_execution::par, [](const int &k, const int &v)
+                          { return k == -v; }) == input.size());
+
+    dense_execution::set_default_executor(nullptr);
+    assert(&dense_execution::default_executor() != &pool);
+
+    std::cout << "✓ Work-stealing executor tests passed!" << std::endl;
+}
+
 void benchmark_concurrent_vs_sequential()
 {
     std::cout << "\n=== Concurrent vs Sequential Performance ===" << std::endl;
@@ -211,6 +602,12 @@ int main()
     {
         test_concurrent_basic();
         test_concurrent_multithreaded();
+        test_segment_splitting();
+        test_clustered_inserts();
+        test_concurrent_precomputed_hash();
+        test_sharded_map();
+        test_thread_local_aggregator();
+        test_work_stealing_executor();
         benchmark_concurrent_vs_sequential();
 
         std::cout << "\n🎉 All concurrent tests completed!" << std::endl;
@@ -1,4 +1,14 @@
 #include "../include/unordered_dense_map.hpp"
+#include "../include/hash_join.hpp"
+#include "../include/flat_dense_map.hpp"
+#include "../include/split_dense_map.hpp"
+#include "../include/spilling_dense_map.hpp"
+#include "../include/durable_dense_map.hpp"
+#include "../include/constexpr_dense_map.hpp"
+#include "../include/static_dense_map.hpp"
+#include "../include/slot_dense_map.hpp"
+#include "../include/cuckoo_filter.hpp"
+#include "../include/cuckoo_dense_map.hpp"
 #include <iostream>
 #include <chrono>
 #include <random>
@@ -7,6 +17,8 @@
 #include <string>
 #include <iomanip>
 #include <cassert>
+#include <fstream>
+#include <sstream>
 
 using namespace std::chrono;
 
@@ -39,7 +51,13 @@ double benchmark_lookup(const MapType &map, const std::vector<int> &keys)
             auto it = map.find(key);
             if (it != map.end())
             {
-                volatile int dummy = it->value;
+                volatile int dummy = [](const auto &entry)
+                {
+                    if constexpr (requires { entry.second; })
+                        return entry.second;
+                    else
+                        return entry.value;
+                }(*it);
                 (void)dummy;
             }
         }
@@ -346,6 +364,1338 @@ void test_edge_cases()
     std::cout << "✓ Edge case tests passed!" << std::endl;
 }
 
+// Single-pass input iterator over "key value" pairs in a stream
+struct pair_reader
+{
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::pair<int, int>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    std::istream *in = nullptr;
+    value_type pair{};
+
+    pair_reader &operator++()
+    {
+        if (!(*in >> pair.first >> pair.second))
+            in = nullptr;
+        return *this;
+    }
+    reference operator*() const { return pair; }
+    pointer operator->() const { return &pair; }
+    bool operator==(const pair_reader &other) const { return in == other.in; }
+};
+
+void test_parallel_rehash_and_build()
+{
+    std::cout << "\n=== Testing Parallel Rehash and Build ===" << std::endl;
+
+    const int n = 200000;
+
+    unordered_dense_map<int, int> map;
+    for (int i = 0; i < n; ++i)
+    {
+        map[i] = i * 3;
+    }
+    map.parallel_rehash(1 << 20, 4);
+    assert(map.size() == static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i)
+    {
+        auto it = map.find(i);
+        assert(it != map.end() && it->value == i * 3);
+    }
+    assert(!map.contains(n));
+
+    // Duplicates inside the input and against existing keys: first one wins
+    std::vector<std::pair<int, int>> input;
+    for (int i = 0; i < n; ++i)
+    {
+        input.emplace_back(i % (n / 2), i);
+    }
+
+    unordered_dense_map<int, int> built;
+    built[7] = -1;
+    built.parallel_build(input.begin(), input.end(), 4);
+    assert(built.size() == static_cast<size_t>(n / 2));
+    assert(built[7] == -1);
+    for (int k = 0; k < n / 2; ++k)
+    {
+        auto it = built.find(k);
+        assert(it != built.end());
+        assert(k == 7 || it->value == k);
+    }
+
+    // A single-pass input range is read exactly once
+    std::istringstream text("1 10 2 20 1 30 3 40");
+    pair_reader reader{&text};
+    ++reader;
+    unordered_dense_map<int, int> streamed;
+    streamed.parallel_build(reader, pair_reader{}, 4);
+    assert(streamed.size() == 3 && streamed[1] == 10 && streamed[2] == 20 && streamed[3] == 40);
+
+    // The single-threaded partitioned build shares the same semantics
+    unordered_dense_map<int, int> partitioned;
+    partitioned[7] = -1;
+    partitioned.build_partitioned(input);
+    assert(partitioned.size() == static_cast<size_t>(n / 2));
+    for (int k = 0; k < n / 2; ++k)
+    {
+        assert(partitioned[k] == (k == 7 ? -1 : k));
+    }
+
+    // Entries stay densely packed in insertion order
+    auto first = built.begin();
+    assert(first->key == 7);
+    ++first;
+    assert(first->key == 0);
+
+    built.insert(n, n);
+    assert(built.erase(0) == 1);
+    assert(built.contains(n) && !built.contains(0));
+
+    std::cout << "✓ Parallel rehash and build tests passed!" << std::endl;
+}
+
+void test_parallel_algorithms()
+{
+    std::cout << "\n=== Testing Parallel Algorithms ===" << std::endl;
+
+    const int n = 100000;
+    unordered_dense_map<int, long long> map;
+    for (int i = 0; i < n; ++i)
+    {
+        map[i] = i;
+    }
+
+    auto sum = [](long long a, long long b)
+    { return a + b; };
+    auto value_of = [](const int &, const long long &v)
+    { return v; };
+    const long long expected = static_cast<long long>(n) * (n - 1) / 2;
+
+    assert(map.reduce(0LL, sum, value_of) == expected);
+    assert(map.reduce(dense_execution::par, 0LL, sum, value_of) == expected);
+    assert(map.reduce(dense_execution::parallel_policy{3}, 5LL, sum, value_of) == expected + 5);
+
+    auto even = [](const int &k, const long long &)
+    { return k % 2 == 0; };
+    assert(map.count_if(even) == static_cast<size_t>(n / 2));
+    assert(map.count_if(dense_execution::par, even) == static_cast<size_t>(n / 2));
+
+    map.transform_values(dense_execution::par, [](const long long &v)
+                         { return v * 2; });
+    map.for_each(dense_execution::parallel_policy{4}, [](const int &k, long long &v)
+                 { v += k; });
+    for (int i = 0; i < n; ++i)
+    {
+        assert(map[i] == 3LL * i);
+    }
+
+    unordered_dense_map<int, long long> empty_map;
+    assert(empty_map.reduce(dense_execution::par, 7LL, sum, value_of) == 7);
+    assert(empty_map.count_if(dense_execution::par, even) == 0);
+
+    std::cout << "✓ Parallel algorithm tests passed!" << std::endl;
+}
+
+void test_set_operations()
+{
+    std::cout << "\n=== Testing Set Operations ===" << std::endl;
+
+    // a holds [0, 60000), b holds the even keys of [40000, 140000)
+    unordered_dense_map<int, int> a, b;
+    for (int i = 0; i < 60000; ++i)
+    {
+        a[i] = i;
+    }
+    for (int i = 40000; i < 140000; i += 2)
+    {
+        b[i] = -i;
+    }
+
+    auto in_a = [](int k)
+    { return k >= 0 && k < 60000; };
+    auto in_b = [](int k)
+    { return k >= 40000 && k < 140000 && k % 2 == 0; };
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        auto inter = pass ? a.intersect(dense_execution::par, b) : a.intersect(b);
+        auto diff = pass ? a.difference(dense_execution::par, b) : a.difference(b);
+        auto rdiff = pass ? b.difference(dense_execution::par, a) : b.difference(a);
+        auto sym = pass ? a.symmetric_difference(dense_execution::par, b) : a.symmetric_difference(b);
+
+        assert(inter.size() == 10000);
+        assert(diff.size() == 50000);
+        assert(rdiff.size() == 40000);
+        assert(sym.size() == 90000);
+        for (const auto &e : inter)
+        {
+            assert(in_a(e.key) && in_b(e.key) && e.value == e.key);
+        }
+        for (const auto &e : diff)
+        {
+            assert(in_a(e.key) && !in_b(e.key));
+        }
+        for (const auto &e : rdiff)
+        {
+            assert(in_b(e.key) && !in_a(e.key) && e.value == -e.key);
+        }
+        for (const auto &e : sym)
+        {
+            assert(in_a(e.key) != in_b(e.key));
+        }
+    }
+
+    // Smaller side on the left goes through the other code paths
+    auto small_inter = b.intersect(a);
+    assert(small_inter.size() == 10000);
+    assert(small_inter[40000] == -40000);
+
+    auto u = a;
+    u.union_with(b);
+    assert(u.size() == 100000);
+    assert(u[40000] == 40000 && u[138000] == -138000);
+
+    auto summed = a;
+    summed.union_with(dense_execution::par, b, [](int x, int y)
+                      { return x + y; });
+    assert(summed.size() == 100000);
+    assert(summed[40000] == 0 && summed[41] == 41 && summed[100000] == -100000);
+
+    // Batch lookups report presence in input order
+    std::vector<int> probe = {5, 70000, 59999, 60000, -1};
+    std::vector<bool> found = a.batch_contains(probe.begin(), probe.end());
+    assert(found == std::vector<bool>({true, false, true, false, false}));
+
+    std::cout << "✓ Set operation tests passed!" << std::endl;
+}
+
+void test_sorted_export()
+{
+    std::cout << "\n=== Testing Sorted Export ===" << std::endl;
+
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dis(std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+
+    unordered_dense_map<int, int> ints;
+    for (int i = 0; i < 50000; ++i)
+    {
+        ints[dis(gen)] = i;
+    }
+    ints[0] = -1;
+    ints[std::numeric_limits<int>::min()] = -2;
+
+    auto first_key = ints.begin()->key;
+    auto sorted = ints.export_sorted();
+    assert(sorted.size() == ints.size());
+    assert(sorted.front().first == std::numeric_limits<int>::min());
+    for (size_t i = 1; i < sorted.size(); ++i)
+    {
+        assert(sorted[i - 1].first < sorted[i].first);
+        assert(ints[sorted[i].first] == sorted[i].second);
+    }
+    assert(ints.begin()->key == first_key); // map order untouched
+
+    unordered_dense_map<double, int> doubles;
+    for (double d : {3.5, -0.25, 1e300, -1e300, 0.0, -7.0, 2.0})
+    {
+        doubles[d] = 1;
+    }
+    auto view = doubles.sorted_view();
+    assert(view.size() == 7);
+    double previous = -std::numeric_limits<double>::infinity();
+    for (const auto &entry : view)
+    {
+        assert(previous < entry.key);
+        previous = entry.key;
+    }
+    assert(view[0].key == -1e300 && view[6].key == 1e300);
+
+    // Keys without a radix image go through std::sort
+    unordered_dense_map<std::string, int> words;
+    words["pear"] = 1;
+    words["apple"] = 2;
+    words["fig"] = 3;
+    auto sorted_words = words.export_sorted();
+    assert(sorted_words[0].first == "apple" && sorted_words[1].first == "fig" && sorted_words[2].first == "pear");
+
+    std::cout << "✓ Sorted export tests passed!" << std::endl;
+}
+
+void test_columnar_aggregate()
+{
+    std::cout << "\n=== Testing Columnar Aggregation ===" << std::endl;
+
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> key_dis(0, 4999);
+    std::uniform_int_distribution<int> value_dis(-1000, 1000);
+
+    std::vector<int> keys(200000);
+    std::vector<int> values(keys.size());
+    std::unordered_map<int, long long> ref_sum, ref_count;
+    std::unordered_map<int, int> ref_min, ref_max;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        keys[i] = key_dis(gen);
+        values[i] = value_dis(gen);
+        ref_sum[keys[i]] += values[i];
+        ref_count[keys[i]] += 1;
+        auto [mn, new_min] = ref_min.try_emplace(keys[i], values[i]);
+        mn->second = std::min(mn->second, values[i]);
+        auto [mx, new_max] = ref_max.try_emplace(keys[i], values[i]);
+        mx->second = std::max(mx->second, values[i]);
+    }
+
+    unordered_dense_map<int, long long> sums, counts;
+    unordered_dense_map<int, int> mins, maxs;
+    sums.aggregate(keys, values, dense_aggregate::sum{});
+    counts.aggregate(keys, dense_aggregate::count{}, 64);
+    mins.aggregate(keys, values, dense_aggregate::min{}, 1);
+    maxs.aggregate(keys, values, dense_aggregate::max{}, 4096);
+
+    assert(sums.size() == ref_sum.size() && counts.size() == ref_sum.size());
+    for (const auto &[key, sum] : ref_sum)
+    {
+        assert(sums[key] == sum);
+        assert(counts[key] == ref_count[key]);
+        assert(mins[key] == ref_min[key]);
+        assert(maxs[key] == ref_max[key]);
+    }
+
+    // Plain functor without init(): new groups start at Value{}
+    unordered_dense_map<int, long long> squares;
+    squares.aggregate(keys, values, [](long long &acc, int v)
+                      { acc += static_cast<long long>(v) * v; });
+    long long expected = 0, total = 0;
+    for (int v : values)
+    {
+        expected += static_cast<long long>(v) * v;
+    }
+    for (const auto &entry : squares)
+    {
+        total += entry.value;
+    }
+    assert(total == expected);
+
+    std::cout << "✓ Columnar aggregation tests passed!" << std::endl;
+}
+
+void test_hash_join()
+{
+    std::cout << "\n=== Testing Hash Join ===" << std::endl;
+
+    // Build keys 0..9999 with every multiple of 10 appearing three times
+    std::vector<int> build;
+    for (int k = 0; k < 10000; ++k)
+    {
+        build.push_back(k);
+        if (k % 10 == 0)
+        {
+            build.push_back(k);
+            build.push_back(k);
+        }
+    }
+    hash_join<int> join(build);
+    assert(join.build_rows() == build.size());
+    assert(join.distinct_keys() == 10000);
+
+    std::vector<int> probe;
+    for (int k = -5000; k < 45000; ++k)
+    {
+        probe.push_back(k % 20000);
+    }
+
+    join_matches inner, inner_par, semi, anti;
+    join.probe(join_type::inner, probe, inner);
+    join.probe(dense_execution::parallel_policy{4}, join_type::inner, probe, inner_par);
+    join.probe(join_type::semi, probe, semi);
+    join.probe(join_type::anti, probe, anti);
+
+    assert(inner.probe_rows == inner_par.probe_rows && inner.build_rows == inner_par.build_rows);
+    assert(semi.size() + anti.size() == probe.size());
+    assert(semi.build_rows.empty());
+
+    size_t expected_inner = 0;
+    for (int k : probe)
+    {
+        if (k >= 0 && k < 10000)
+        {
+            expected_inner += (k % 10 == 0) ? 3 : 1;
+        }
+    }
+    assert(inner.size() == expected_inner);
+    for (size_t m = 0; m < inner.size(); ++m)
+    {
+        assert(probe[inner.probe_rows[m]] == build[inner.build_rows[m]]);
+        if (m > 0 && inner.probe_rows[m] == inner.probe_rows[m - 1])
+        {
+            assert(inner.build_rows[m] > inner.build_rows[m - 1]);
+        }
+    }
+    for (size_t row : anti.probe_rows)
+    {
+        assert(probe[row] < 0 || probe[row] >= 10000);
+    }
+
+    std::cout << "✓ Hash join tests passed!" << std::endl;
+}
+
+void test_flat_dense_map()
+{
+    std::cout << "\n=== Testing Flat Dense Map ===" << std::endl;
+
+    static_assert(std::is_same_v<dense_map<uint32_t, uint32_t>, flat_dense_map<uint32_t, uint32_t>>);
+    static_assert(std::is_same_v<dense_map<std::string, int>, unordered_dense_map<std::string, int>>);
+
+    // Random inserts and erases checked against std::unordered_map; erases
+    // exercise backward shifting across long runs and wrap-around
+    flat_dense_map<uint32_t, uint32_t> map;
+    std::unordered_map<uint32_t, uint32_t> reference;
+    std::mt19937 gen(7);
+    for (int i = 0; i < 200000; ++i)
+    {
+        uint32_t key = gen() % 20000;
+        if (gen() % 3 == 0)
+        {
+            assert(map.erase(key) == reference.erase(key));
+        }
+        else
+        {
+            auto [it, inserted] = map.insert(key, static_cast<uint32_t>(i));
+            assert(inserted == reference.emplace(key, i).second);
+            assert(it->key == key && it->value == reference[key]);
+        }
+    }
+    assert(map.size() == reference.size());
+    for (const auto &[key, value] : reference)
+    {
+        assert(map.at(key) == value);
+    }
+
+    size_t visited = 0;
+    for (const auto &entry : map)
+    {
+        assert(reference.at(entry.key) == entry.value);
+        ++visited;
+    }
+    assert(visited == map.size());
+
+    std::vector<uint32_t> keys(30000);
+    std::iota(keys.begin(), keys.end(), 0u);
+    std::vector<bool> present = map.batch_contains(keys.begin(), keys.end());
+    for (uint32_t k : keys)
+    {
+        assert(present[k] == reference.contains(k));
+    }
+
+    map[5] += 1;
+    map.clear();
+    assert(map.empty() && map.find(5) == map.end());
+
+    // Opt-in for a non-trivial key type
+    flat_dense_map<std::string, int> words;
+    words["alpha"] = 1;
+    words["beta"] = 2;
+    assert(words.erase("alpha") == 1 && !words.contains("alpha") && words.at("beta") == 2);
+
+    std::cout << "✓ Flat dense map tests passed!" << std::endl;
+}
+
+void test_split_dense_map()
+{
+    std::cout << "\n=== Testing Split (SoA) Dense Map ===" << std::endl;
+
+    struct Payload
+    {
+        int id = 0;
+        char bytes[196] = {};
+    };
+
+    split_dense_map<int, Payload> map;
+    std::unordered_map<int, int> reference;
+    std::mt19937 gen(9);
+    for (int i = 0; i < 100000; ++i)
+    {
+        int key = static_cast<int>(gen() % 10000);
+        if (gen() % 3 == 0)
+        {
+            assert(map.erase(key) == reference.erase(key));
+        }
+        else
+        {
+            auto [it, inserted] = map.try_emplace(key, Payload{i});
+            assert(inserted == reference.emplace(key, i).second);
+            assert(it->key == key && it->value.id == reference[key]);
+        }
+    }
+    assert(map.size() == reference.size());
+
+    // The columns stay parallel through erase's move-last fill
+    auto keys = map.keys();
+    auto values = map.values();
+    assert(keys.size() == reference.size() && values.size() == keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        assert(values[i].id == reference.at(keys[i]));
+        assert(map.at(keys[i]).id == values[i].id);
+    }
+
+    size_t visited = 0;
+    for (auto [key, value] : map)
+    {
+        assert(value.id == reference.at(key));
+        ++visited;
+    }
+    assert(visited == map.size());
+
+    map[-1].id = 5;
+    assert(map.contains(-1) && map.find(-1)->value.id == 5);
+    map.clear();
+    assert(map.empty() && map.keys().empty() && !map.contains(-1));
+
+    // A throwing value constructor leaves the columns parallel
+    split_dense_map<int, std::string> strings;
+    strings.insert(1, "one");
+    bool threw = false;
+    try
+    {
+        strings.try_emplace(2, std::string::npos, 'x');
+    }
+    catch (const std::length_error &)
+    {
+        threw = true;
+    }
+    assert(threw && strings.size() == 1 && strings.keys().size() == strings.values().size());
+    assert(!strings.contains(2) && strings.at(1) == "one");
+    assert(strings.insert(2, "two").second && strings.at(2) == "two");
+
+    std::cout << "✓ Split dense map tests passed!" << std::endl;
+}
+
+void test_copy_on_write_snapshot()
+{
+    std::cout << "\n=== Testing Copy-on-Write Snapshots ===" << std::endl;
+
+    using cow_map = unordered_dense_map<int, std::string, detail::hash_traits<int>, dense_storage::copy_on_write<64>>;
+
+    cow_map map;
+    std::unordered_map<int, std::string> expected;
+    for (int i = 0; i < 20000; ++i)
+    {
+        map[i] = std::to_string(i);
+        expected[i] = std::to_string(i);
+    }
+
+    const cow_map snapshot = map.snapshot();
+    auto matches = [](const cow_map &m, const std::unordered_map<int, std::string> &ref)
+    {
+        if (m.size() != ref.size())
+            return false;
+        for (const auto &entry : m)
+        {
+            auto it = ref.find(entry.key);
+            if (it == ref.end() || it->second != entry.value)
+                return false;
+        }
+        return true;
+    };
+
+    // Every kind of mutation on the live map, including the parallel paths
+    std::unordered_map<int, std::string> live = expected;
+    for (int i = 0; i < 20000; i += 3)
+    {
+        map.erase(i);
+        live.erase(i);
+    }
+    map[7] = "seven";
+    live[7] = "seven";
+    map.transform_values(dense_execution::parallel_policy{4}, [](const std::string &v)
+                         { return v + "!"; });
+    for (auto &[key, value] : live)
+    {
+        value += "!";
+    }
+    std::vector<std::pair<int, std::string>> extra;
+    for (int i = 30000; i < 40000; ++i)
+    {
+        extra.emplace_back(i, "x");
+        live[i] = "x";
+    }
+    map.parallel_build(extra.begin(), extra.end(), 4);
+    cow_map other;
+    other[1] = "a";
+    other[50000] = "b";
+    map.union_with(dense_execution::parallel_policy{4}, other, [](const std::string &a, const std::string &b)
+                   { return a + b; });
+    live[1] += "a";
+    live[50000] = "b";
+
+    assert(matches(map, live));
+    assert(matches(snapshot, expected));
+
+    // Snapshots of snapshots, and writes to the snapshot side
+    cow_map second = map.snapshot();
+    second.clear();
+    assert(second.empty() && matches(map, live));
+
+    std::cout << "✓ Copy-on-write snapshot tests passed!" << std::endl;
+}
+
+void test_chunked_storage()
+{
+    std::cout << "\n=== Testing Chunked Entry Storage ===" << std::endl;
+
+    using chunked_map = unordered_dense_map<int, std::string, detail::hash_traits<int>, dense_storage::chunked<64>>;
+
+    chunked_map map;
+    auto [first, inserted] = map.try_emplace(-1, "first");
+    assert(inserted);
+    std::string *held = &first->value;
+
+    // Many growth steps later the entry has not moved
+    for (int i = 0; i < 20000; ++i)
+    {
+        map[i] = std::to_string(i);
+    }
+    assert(held == &map.at(-1) && *held == "first");
+
+    // Iteration is in insertion order, across chunk boundaries
+    int expected_key = -1;
+    for (const auto &entry : map)
+    {
+        assert(entry.key == expected_key++);
+    }
+    assert(expected_key == 20000);
+
+    for (int i = 0; i < 20000; i += 2)
+    {
+        assert(map.erase(i) == 1);
+    }
+    assert(map.size() == 10001);
+    for (int i = 0; i < 20000; ++i)
+    {
+        assert(map.contains(i) == (i % 2 == 1));
+    }
+
+    // Copies are deep
+    chunked_map copy = map;
+    copy[1] = "changed";
+    assert(map.at(1) == "1" && copy.at(1) == "changed");
+
+    std::cout << "✓ Chunked storage tests passed!" << std::endl;
+}
+
+void test_shrink_policy()
+{
+    std::cout << "\n=== Testing Shrink Policy ===" << std::endl;
+
+    unordered_dense_map<int, int> map;
+    map.set_shrink_policy({0.125f});
+    for (int i = 0; i < 100000; ++i)
+    {
+        map[i] = i;
+    }
+    const size_t peak_buckets = map.bucket_count();
+
+    // Mass erasure shrinks the index on the way down
+    for (int i = 1000; i < 100000; ++i)
+    {
+        assert(map.erase(i) == 1);
+    }
+    assert(map.size() == 1000);
+    assert(map.bucket_count() < peak_buckets / 16);
+    for (int i = 0; i < 100000; ++i)
+    {
+        assert(map.contains(i) == (i < 1000));
+    }
+
+    // Hysteresis: churn across the shrink threshold resizes only once
+    while (map.size() - 1 >= map.bucket_count() * 0.125f)
+    {
+        map.erase(static_cast<int>(map.size()) - 1);
+    }
+    const int churn_key = static_cast<int>(map.size()) - 1;
+    size_t resizes = 0;
+    size_t buckets = map.bucket_count();
+    for (int i = 0; i < 10000; ++i)
+    {
+        map.erase(churn_key);
+        map[churn_key] = churn_key;
+        resizes += map.bucket_count() != buckets;
+        buckets = map.bucket_count();
+    }
+    assert(resizes == 1 && map.at(churn_key) == churn_key);
+
+    // Explicit shrink, also with chunked entries, and policy validation
+    unordered_dense_map<int, int, detail::hash_traits<int>, dense_storage::chunked<64>> chunked;
+    for (int i = 0; i < 10000; ++i)
+    {
+        chunked[i] = i;
+    }
+    for (int i = 100; i < 10000; ++i)
+    {
+        chunked.erase(i);
+    }
+    chunked.shrink_to_fit();
+    assert(chunked.bucket_count() == 256 && chunked.size() == 100 && chunked.at(99) == 99);
+
+    bool threw = false;
+    try
+    {
+        map.set_shrink_policy({0.5f});
+    }
+    catch (const std::invalid_argument &)
+    {
+        threw = true;
+    }
+    assert(threw && map.get_shrink_policy().low_water == 0.125f);
+
+    std::cout << "✓ Shrink policy tests passed!" << std::endl;
+}
+
+void test_spilling_dense_map()
+{
+    std::cout << "\n=== Testing Spilling Dense Map ===" << std::endl;
+
+    const auto directory = std::filesystem::temp_directory_path() / "udm_spill_test";
+    std::filesystem::remove_all(directory);
+    {
+        // Every key arrives five times, far apart, with a tight memory budget
+        spilling_dense_map<int, long long, std::plus<long long>> counts(directory, 2000, 16);
+        for (int round = 0; round < 5; ++round)
+        {
+            for (int i = 0; i < 20000; ++i)
+            {
+                counts.insert(i, i);
+            }
+        }
+        assert(counts.spilled_records() > 0);
+        assert(counts.resident_size() <= 2000);
+
+        size_t keys = 0;
+        std::vector<bool> seen(20000, false);
+        counts.for_each_partition([&](size_t, auto &partition)
+                                  {
+            for (const auto &entry : partition)
+            {
+                assert(!seen[entry.key] && entry.value == 5LL * entry.key);
+                seen[entry.key] = true;
+                ++keys;
+            } });
+        assert(keys == 20000);
+        assert(!std::filesystem::is_empty(directory));
+
+        // Keep-first by default, across spills
+        spilling_dense_map<int, int> first(directory, 10, 2);
+        for (int i = 0; i < 100; ++i)
+        {
+            first.insert(i, i);
+        }
+        for (int i = 0; i < 100; ++i)
+        {
+            first.insert(i, -1);
+        }
+        first.for_each_partition([](size_t, auto &partition)
+                                 {
+            for (const auto &entry : partition)
+            {
+                assert(entry.value == entry.key);
+            } });
+    }
+    assert(std::filesystem::is_empty(directory));
+    std::filesystem::remove(directory);
+
+    std::cout << "✓ Spilling dense map tests passed!" << std::endl;
+}
+
+void test_durable_dense_map()
+{
+    std::cout << "\n=== Testing Durable Dense Map ===" << std::endl;
+
+    using durable_map = durable_dense_map<int, long long>;
+    const auto directory = std::filesystem::temp_directory_path() / "udm_wal_test";
+    std::filesystem::remove_all(directory);
+
+    std::unordered_map<int, long long> expected;
+    auto matches = [&](const durable_map &map)
+    {
+        if (map.size() != expected.size())
+            return false;
+        for (const auto &[key, value] : expected)
+        {
+            if (!map.contains(key) || map.at(key) != value)
+                return false;
+        }
+        return true;
+    };
+    auto log_files = [&]()
+    {
+        size_t n = 0;
+        for (const auto &file : std::filesystem::directory_iterator(directory))
+        {
+            n += file.path().filename().string().rfind("wal.", 0) == 0;
+        }
+        return n;
+    };
+
+    {
+        durable_map map(directory, {64, 0});
+        for (int i = 0; i < 5000; ++i)
+        {
+            map.insert(i, i);
+            expected[i] = i;
+        }
+        for (int i = 0; i < 5000; i += 3)
+        {
+            assert(map.erase(i) == 1);
+            expected.erase(i);
+        }
+        map.insert_or_assign(1, -1);
+        expected[1] = -1;
+        assert(!map.insert(1, 5));
+
+        // Mutations keep going while the checkpoint is written
+        map.checkpoint();
+        for (int i = 5000; i < 6000; ++i)
+        {
+            map.insert(i, i);
+            expected[i] = i;
+        }
+        map.commit();
+        map.wait_for_checkpoint();
+        assert(matches(map));
+    }
+    assert(log_files() == 1); // The checkpointed log is gone
+
+    // A crash in the middle of a write leaves a partial record behind
+    {
+        std::ofstream torn(directory / "wal.1", std::ios::binary | std::ios::app);
+        torn.write("partial", 7);
+    }
+    {
+        durable_map map(directory, {64, 0});
+        assert(matches(map));
+        map.erase(5000);
+        expected.erase(5000);
+    }
+
+    // Automatic checkpoints once the log passes compact_bytes
+    {
+        durable_map map(directory, {16, 4096});
+        for (int i = 0; i < 20000; ++i)
+        {
+            map.insert_or_assign(i % 7000, i);
+            expected[i % 7000] = i;
+        }
+        map.commit();
+        map.wait_for_checkpoint();
+        assert(log_files() <= 3);
+    }
+    {
+        durable_map map(directory);
+        assert(matches(map));
+    }
+
+    std::filesystem::remove_all(directory);
+    std::cout << "✓ Durable dense map tests passed!" << std::endl;
+}
+
+void test_constexpr_dense_map()
+{
+    std::cout << "\n=== Testing Constexpr Dense Map ===" << std::endl;
+
+    static constexpr auto keywords = make_constexpr_dense_map<std::string_view, int>(
+        {{"if", 1}, {"else", 2}, {"while", 3}, {"for", 4}, {"return", 5}, {"break", 6}, {"continue", 7}});
+    static_assert(keywords.size() == 7 && keywords.bucket_count() == 16);
+    static_assert(keywords.at("while") == 3 && *keywords.find("continue") == 7);
+    static_assert(!keywords.contains("goto") && keywords.value_or("do", -1) == -1);
+
+    // Larger tables built by a constexpr function
+    static constexpr auto squares = []
+    {
+        std::array<std::pair<int, int>, 1000> items{};
+        for (int i = 0; i < 1000; ++i)
+        {
+            items[i] = {i * 7919, i * i};
+        }
+        return constexpr_dense_map<int, int, 1000>(items);
+    }();
+    static_assert(squares.at(999 * 7919) == 999 * 999 && !squares.contains(1));
+
+    // The same tables at run time, with keys the compiler cannot see
+    std::string word = "return";
+    assert(keywords.at(word) == 5);
+    word = "retur";
+    assert(!keywords.contains(word));
+    for (int i = 0; i < 1000; ++i)
+    {
+        const int key = i * 7919;
+        assert(squares.at(key) == i * i);
+        assert(!squares.contains(key + 1));
+    }
+
+    int order = 1;
+    for (const auto &entry : keywords)
+    {
+        assert(entry.value == order++);
+    }
+
+    std::cout << "✓ Constexpr dense map tests passed!" << std::endl;
+}
+
+void test_static_dense_map()
+{
+    std::cout << "\n=== Testing Static Dense Map ===" << std::endl;
+
+    static_dense_map<int, int, 48> map;
+    static_assert(decltype(map)::bucket_count() == 64);
+    for (int i = 0; i < 48; ++i)
+    {
+        assert(map.insert(i * 31, i).second);
+    }
+    assert(map.full());
+
+    // Full: new keys are refused, existing keys are still found
+    auto [refused, inserted] = map.try_emplace(-1, 0);
+    assert(!inserted && refused == map.end());
+    auto [existing, again] = map.try_emplace(31, 0);
+    assert(!again && existing->value == 1);
+
+    for (int i = 0; i < 48; i += 2)
+    {
+        assert(map.erase(i * 31) == 1);
+    }
+    assert(map.size() == 24 && map.erase(0) == 0);
+    for (int i = 0; i < 48; ++i)
+    {
+        assert(map.contains(i * 31) == (i % 2 == 1));
+    }
+    assert(map.insert(-1, -1).second && map.at(-1) == -1);
+
+    // A throwing value constructor leaves nothing behind
+    static_dense_map<int, std::string, 8> strings;
+    strings.insert(1, "one");
+    bool threw = false;
+    try
+    {
+        strings.try_emplace(2, std::string::npos, 'x');
+    }
+    catch (const std::length_error &)
+    {
+        threw = true;
+    }
+    assert(threw && strings.size() == 1 && !strings.contains(2));
+    assert(strings.insert(2, "two").second && strings.at(2) == "two" && strings.at(1) == "one");
+    assert(strings.erase(2) == 1 && !strings.contains(2));
+
+    // Random churn against a reference, across many fill/erase cycles
+    static_dense_map<uint64_t, uint64_t, 500> large;
+    std::unordered_map<uint64_t, uint64_t> expected;
+    std::mt19937_64 gen(7);
+    for (int op = 0; op < 200000; ++op)
+    {
+        uint64_t key = gen() % 1000;
+        if (gen() % 2)
+        {
+            bool fits = large.size() < 500;
+            auto [it, added] = large.try_emplace(key, key + 1);
+            assert(added == (fits && !expected.count(key)));
+            if (added)
+                expected[key] = key + 1;
+        }
+        else
+        {
+            assert(large.erase(key) == expected.erase(key));
+        }
+    }
+    assert(large.size() == expected.size());
+    for (const auto &entry : large)
+    {
+        assert(expected.at(entry.key) == entry.value);
+    }
+    large.clear();
+    assert(large.empty() && !large.contains(expected.begin()->first));
+
+    std::cout << "✓ Static dense map tests passed!" << std::endl;
+}
+
+void test_precomputed_hash()
+{
+    std::cout << "\n=== Testing Precomputed-Hash API ===" << std::endl;
+
+    using Hash = detail::hash_traits<std::string>;
+    unordered_dense_map<std::string, int> map;
+    std::vector<std::string> keys;
+    for (int i = 0; i < 1000; ++i)
+    {
+        keys.push_back("key" + std::to_string(i));
+    }
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        assert(map.insert_hashed(keys[i], Hash::hash(keys[i]), i).second);
+    }
+    assert(!map.insert_hashed(keys[0], Hash::hash(keys[0]), -1).second);
+    assert(map.size() == 1000 && map.at(keys[0]) == 0);
+
+    // Prefetch a few keys ahead, as a pipelined probe would
+    const auto &view = map;
+    for (int i = 0; i < 1000; ++i)
+    {
+        if (i + 8 < 1000)
+        {
+            view.prefetch(Hash::hash(keys[i + 8]));
+        }
+        auto it = view.find_hashed(keys[i], Hash::hash(keys[i]));
+        assert(it != view.end() && it->value == i);
+        assert(map.find_hashed(keys[i], Hash::hash(keys[i])) == map.find(keys[i]));
+    }
+
+    for (int i = 0; i < 1000; i += 2)
+    {
+        assert(map.erase_hashed(keys[i], Hash::hash(keys[i])) == 1);
+    }
+    assert(map.erase_hashed(keys[0], Hash::hash(keys[0])) == 0);
+    for (int i = 0; i < 1000; ++i)
+    {
+        assert(map.contains(keys[i]) == (i % 2 == 1));
+    }
+    map.prefetch(Hash::hash(keys[0]));
+
+    std::cout << "✓ Precomputed-hash API tests passed!" << std::endl;
+}
+
+void test_slot_dense_map()
+{
+    std::cout << "\n=== Testing Slot Dense Map Handles ===" << std::endl;
+
+    // The positional API the handles are built on
+    unordered_dense_map<std::string, int> dense;
+    for (int i = 0; i < 5; ++i)
+    {
+        dense.insert("a long key that lives on the heap " + std::to_string(i), i);
+    }
+    auto third = dense.find("a long key that lives on the heap 2");
+    assert(third.index() == 2 && dense.entry_at(2).value == 2);
+    dense.erase_at(third.index());
+    assert(dense.size() == 4 && !dense.contains("a long key that lives on the heap 2"));
+    assert(dense.entry_at(2).value == 4 && dense.at("a long key that lives on the heap 4") == 4);
+
+    using Map = slot_dense_map<std::string, int>;
+    Map map;
+    auto [a, added_a] = map.insert("a", 1);
+    auto [b, added_b] = map.insert("b", 2);
+    auto [c, added_c] = map.insert("c", 3);
+    assert(added_a && added_b && added_c);
+    assert(!map.insert("a", 9).second && map.find("a") == a);
+
+    // Erasing "a" moves "c" into its slot; the handle to "c" follows it
+    assert(map.erase("a") == 1);
+    assert(!map.contains(a) && map.get(a) == nullptr);
+    assert(*map.get(c) == 3 && *map.key_of(c) == "c");
+    assert(map.find("a") == Map::handle{});
+
+    // A reused slot gets a new generation, so the stale handle stays dead
+    auto [d, added_d] = map.insert("d", 4);
+    assert(added_d && d.slot == a.slot && d != a);
+    assert(map.get(a) == nullptr && map.at(d) == 4);
+    assert(map.erase(b) && !map.erase(b));
+    assert(map.size() == 2 && map.at("c") == 3);
+
+    // A throwing value constructor takes no slot
+    slot_dense_map<int, std::string> strings;
+    auto first = strings.insert(1, "one").first;
+    bool threw = false;
+    try
+    {
+        strings.try_emplace(2, std::string::npos, 'x');
+    }
+    catch (const std::length_error &)
+    {
+        threw = true;
+    }
+    assert(threw && strings.size() == 1 && !strings.contains(2));
+    auto second = strings.insert(2, "two").first;
+    assert(second.slot == first.slot + 1 && strings.at(second) == "two");
+
+    // Random churn against a reference, with rehashes along the way
+    slot_dense_map<uint64_t, uint64_t> large;
+    std::unordered_map<uint64_t, slot_dense_map<uint64_t, uint64_t>::handle> handles;
+    std::vector<slot_dense_map<uint64_t, uint64_t>::handle> stale;
+    std::mt19937_64 gen(11);
+    for (int op = 0; op < 200000; ++op)
+    {
+        uint64_t key = gen() % 5000;
+        if (gen() % 3)
+        {
+            auto [h, added] = large.try_emplace(key, key * 7);
+            assert(added == !handles.count(key));
+            handles[key] = h;
+        }
+        else if (handles.count(key))
+        {
+            stale.push_back(handles[key]);
+            assert(gen() % 2 ? large.erase(handles[key]) : large.erase(key) == 1);
+            handles.erase(key);
+        }
+    }
+    assert(large.size() == handles.size());
+    for (const auto &[key, h] : handles)
+    {
+        assert(*large.get(h) == key * 7 && *large.key_of(h) == key);
+    }
+    for (const auto &h : stale)
+    {
+        assert(!large.contains(h));
+    }
+
+    size_t visited = 0;
+    large.for_each([&](auto h, const uint64_t &key, uint64_t &value)
+                   {
+        assert(handles.at(key) == h && value == key * 7);
+        ++visited; });
+    assert(visited == handles.size());
+
+    large.clear();
+    assert(large.empty() && !large.contains(handles.begin()->second));
+
+    std::cout << "✓ Slot dense map tests passed!" << std::endl;
+}
+
+void test_bloom_filter()
+{
+    std::cout << "\n=== Testing Bloom Filter Front ===" << std::endl;
+
+    // The filter alone: no false negatives, and few false positives at
+    // about 10 bits per key
+    detail::blocked_bloom_filter filter;
+    filter.reset(160);
+    std::mt19937_64 gen(5);
+    std::vector<uint64_t> inserted(8192);
+    for (auto &hash : inserted)
+    {
+        hash = gen();
+        filter.insert(hash);
+    }
+    for (uint64_t hash : inserted)
+    {
+        assert(filter.may_contain(hash));
+    }
+    size_t false_positives = 0;
+    for (int i = 0; i < 100000; ++i)
+    {
+        false_positives += filter.may_contain(gen());
+    }
+    assert(false_positives < 3000);
+
+    // Behind the map, through growth, erasure, rebuilds and a parallel build
+    unordered_dense_map<int, int> map;
+    for (int i = 0; i < 1000; ++i)
+    {
+        map.insert(i, i);
+    }
+    map.set_bloom_filter(true);
+    assert(map.has_bloom_filter());
+    for (int i = 1000; i < 50000; ++i)
+    {
+        map.insert(i, i);
+    }
+    for (int i = 0; i < 50000; i += 3)
+    {
+        assert(map.erase(i) == 1);
+    }
+    std::vector<std::pair<int, int>> more;
+    for (int i = 50000; i < 70000; ++i)
+    {
+        more.emplace_back(i, i);
+    }
+    map.parallel_build(more.begin(), more.end(), 4);
+    for (int i = 0; i < 80000; ++i)
+    {
+        bool present = i < 70000 && (i >= 50000 || i % 3 != 0);
+        assert(map.contains(i) == present);
+    }
+    std::vector<int> probe = {1, 3, 69999, 70000, -1};
+    assert((map.batch_contains(probe.begin(), probe.end()) == std::vector<bool>{true, false, true, false, false}));
+
+    map.shrink_to_fit();
+    assert(map.contains(1) && !map.contains(3));
+    map.clear();
+    assert(!map.contains(1) && map.insert(1, 1).second && map.contains(1));
+    map.set_bloom_filter(false);
+    assert(!map.has_bloom_filter() && map.contains(1));
+
+    std::cout << "✓ Bloom filter tests passed!" << std::endl;
+}
+
+void test_cuckoo_filter()
+{
+    std::cout << "\n=== Testing Cuckoo Filter ===" << std::endl;
+
+    unordered_dense_map<uint64_t, int> map;
+    std::mt19937_64 gen(9);
+    for (int i = 0; i < 100000; ++i)
+    {
+        map.insert(gen(), i);
+    }
+
+    auto filter = cuckoo_filter<uint64_t>::from_map(map);
+    assert(filter.size() == map.size());
+    assert(filter.memory_bytes() < map.size() * 12 / 10); // About a byte per key
+    for (const auto &entry : map)
+    {
+        assert(filter.contains(entry.key));
+    }
+
+    std::vector<uint64_t> absent(100000);
+    for (auto &key : absent)
+    {
+        key = gen();
+    }
+    size_t false_positives = 0;
+    for (uint64_t key : absent)
+    {
+        false_positives += filter.contains(key);
+    }
+    assert(false_positives < 4000);
+
+    // Batch queries agree with single ones, across both SIMD and tail lanes
+    std::vector<uint64_t> mixed;
+    auto present = map.begin();
+    for (size_t i = 0; i < 2011; ++i)
+    {
+        mixed.push_back(i % 3 ? absent[i] : (present++)->key);
+    }
+    auto batch = filter.batch_contains(mixed.begin(), mixed.end());
+    for (size_t i = 0; i < mixed.size(); ++i)
+    {
+        assert(batch[i] == filter.contains(mixed[i]));
+    }
+
+    // Deleting half the keys keeps the rest and frees their room
+    size_t erased = 0;
+    for (const auto &entry : map)
+    {
+        if (entry.value % 2 == 0)
+        {
+            assert(filter.erase(entry.key));
+            ++erased;
+        }
+    }
+    assert(filter.size() == map.size() - erased);
+    for (const auto &entry : map)
+    {
+        if (entry.value % 2 == 1)
+        {
+            assert(filter.contains(entry.key));
+        }
+    }
+    for (int i = 0; i < 40000; ++i)
+    {
+        assert(filter.insert(absent[i]));
+    }
+    for (int i = 0; i < 40000; ++i)
+    {
+        assert(filter.contains(absent[i]));
+    }
+
+    // A filter at its capacity refuses further keys rather than losing one
+    cuckoo_filter<uint64_t> small(64);
+    size_t stored = 0;
+    std::vector<uint64_t> keys;
+    while (stored < 1000)
+    {
+        keys.push_back(gen());
+        if (!small.insert(keys.back()))
+        {
+            keys.pop_back();
+            break;
+        }
+        ++stored;
+    }
+    assert(stored >= 64 && stored < 1000);
+    for (uint64_t key : keys)
+    {
+        assert(small.contains(key));
+    }
+
+    // Repeated hashes, more than two buckets hold, are stored once
+    std::vector<uint64_t> repeated(100, 0x1234);
+    repeated.push_back(0x5678);
+    auto deduplicated = cuckoo_filter<uint64_t>::from_hashes(repeated);
+    assert(deduplicated.size() == 2);
+    assert(deduplicated.contains_hashed(0x1234) && deduplicated.contains_hashed(0x5678));
+
+    std::cout << "✓ Cuckoo filter tests passed!" << std::endl;
+}
+
+void test_cuckoo_dense_map()
+{
+    std::cout << "\n=== Testing Cuckoo Dense Map ===" << std::endl;
+
+    cuckoo_dense_map<std::string, int> small;
+    assert(small.insert("a", 1).second && !small.insert("a", 2).second);
+    small["b"] = 2;
+    assert(small.at("a") == 1 && small.at("b") == 2 && small.size() == 2);
+    assert(small.erase("a") == 1 && small.erase("a") == 0);
+    assert(!small.contains("a") && small.at("b") == 2);
+
+    // Reserved for the final size, the index ends up about 95% full
+    const size_t n = 200000;
+    cuckoo_dense_map<uint64_t, uint64_t> full;
+    full.reserve(n);
+    const size_t reserved = full.bucket_count();
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        assert(full.insert(i * 0x9E3779B97F4A7C15ull, i).second);
+    }
+    assert(full.bucket_count() == reserved);
+    assert(full.load_factor() > 0.9f);
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        auto it = full.find(i * 0x9E3779B97F4A7C15ull);
+        assert(it != full.end() && it->value == i);
+    }
+
+    // Random churn against a reference, with growth along the way, on both
+    // contiguous and chunked entry storage
+    cuckoo_dense_map<uint64_t, uint64_t> map;
+    cuckoo_dense_map<uint64_t, uint64_t, detail::hash_traits<uint64_t>, dense_storage::chunked<256>> chunked;
+    std::unordered_map<uint64_t, uint64_t> expected;
+    std::mt19937_64 gen(13);
+    for (int op = 0; op < 300000; ++op)
+    {
+        uint64_t key = gen() % 20000;
+        if (gen() % 3)
+        {
+            bool added = !expected.count(key);
+            assert(map.try_emplace(key, key + 1).second == added);
+            assert(chunked.try_emplace(key, key + 1).second == added);
+            expected.emplace(key, key + 1);
+        }
+        else
+        {
+            size_t erased = expected.erase(key);
+            assert(map.erase(key) == erased && chunked.erase(key) == erased);
+        }
+    }
+    assert(map.size() == expected.size() && chunked.size() == expected.size());
+    for (const auto &entry : map)
+    {
+        assert(expected.at(entry.key) == entry.value && chunked.at(entry.key) == entry.value);
+    }
+    for (uint64_t key = 0; key < 20000; ++key)
+    {
+        assert(map.contains(key) == (expected.count(key) == 1));
+    }
+    map.clear();
+    assert(map.empty() && !map.contains(expected.begin()->first));
+
+    std::cout << "✓ Cuckoo dense map tests passed!" << std::endl;
+}
+
 int main()
 {
     std::cout << "Unordered Dense Map Test Suite" << std::endl;
@@ -359,6 +1709,26 @@ int main()
         test_backward_shift_deletion();
         test_simd_optimizations();
         test_edge_cases();
+        test_parallel_rehash_and_build();
+        test_parallel_algorithms();
+        test_set_operations();
+        test_sorted_export();
+        test_columnar_aggregate();
+        test_hash_join();
+        test_flat_dense_map();
+        test_split_dense_map();
+        test_copy_on_write_snapshot();
+        test_chunked_storage();
+        test_shrink_policy();
+        test_spilling_dense_map();
+        test_durable_dense_map();
+        test_constexpr_dense_map();
+        test_static_dense_map();
+        test_precomputed_hash();
+        test_slot_dense_map();
+        test_bloom_filter();
+        test_cuckoo_filter();
+        test_cuckoo_dense_map();
         performance_comparison();
 
         std::cout << "\n🎉 All tests passed successfully!" << std::endl;
@@ -20,13 +20,18 @@ namespace detail
 
         const uint8_t *p = static_cast<const uint8_t *>(key);
         uint64_t a, b;
+        seed ^= wyhash64_mum(seed ^ wyhash64_a, wyhash64_b); // Keeps b ^ seed away from zero
 
         if (len <= 16)
         {
             if (len >= 4)
             {
-                a = (static_cast<uint64_t>(p[0]) << 32) | (static_cast<uint64_t>(p[len >> 1]) << 16) | (static_cast<uint64_t>(p[len - 2]) << 8) | p[len - 1];
-                b = (static_cast<uint64_t>(p[len - 4]) << 32) | (static_cast<uint64_t>(p[len - 3]) << 16) | (static_cast<uint64_t>(p[len - 2]) << 8) | p[len - 1];
+                // Two 4-byte words from each end, as in upstream wyhash, so
+                // every input byte is read. Sampling single bytes left b at
+                // zero for 8-byte keys below 2^32, which zeroed the hash.
+                const size_t shift = (len >> 3) << 2;
+                a = (wyhash64_read(p, 4) << 32) | wyhash64_read(p + shift, 4);
+                b = (wyhash64_read(p + len - 4, 4) << 32) | wyhash64_read(p + len - 4 - shift, 4);
             }
             else if (len > 0)
             {